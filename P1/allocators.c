@@ -0,0 +1,243 @@
+/**
+ *
+ * allocators.c: Pluggable allocator backends for the benchmarks
+ *
+ * See allocators.h for the backend spec syntax.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <dlfcn.h>
+#include "allocators.h"
+
+#define MYMALLOC_NO_MACROS
+#include "mymalloc.h"
+#include "heaps.h"
+
+static void *system_malloc(size_t size) {
+    return malloc(size);
+}
+
+static void system_free(void *ptr) {
+    free(ptr);
+}
+
+static void *mymalloc_backend(size_t size) {
+    return mymalloc(size, MM_SITE());
+}
+
+static void mymalloc_backend_free(void *ptr) {
+    myfree(ptr, MM_SITE());
+}
+
+static void mymalloc_backend_usage(allocator_usage_t *usage) {
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    usage->peak_requested = stats.peak_requested;
+    usage->peak_held = stats.peak_held;
+    usage->heap_size = stats.heap_size;
+}
+
+// Backends for the template heaps in heaps.h
+#define HEAP_BACKEND(name) \
+    static void *name##_backend(size_t size) { \
+        return heap_##name##_malloc(size, MM_SITE()); \
+    } \
+    static void name##_backend_free(void *ptr) { \
+        heap_##name##_free(ptr, MM_SITE()); \
+    } \
+    static void name##_backend_usage(allocator_usage_t *usage) { \
+        heap_stats_t stats; \
+        heap_##name##_stats(&stats); \
+        usage->peak_requested = stats.peak_requested; \
+        usage->peak_held = stats.peak_held; \
+        usage->heap_size = stats.heap_size; \
+    }
+
+HEAP_BACKEND(firstfit)
+HEAP_BACKEND(bestfit)
+HEAP_BACKEND(classes)
+HEAP_BACKEND(sidemeta)
+
+static const allocator_t builtin_allocators[] = {
+    {"mymalloc", mymalloc_backend, mymalloc_backend_free,
+     mymalloc_backend_usage, mymalloc_reset_peak},
+    {"system",   system_malloc,    system_free, NULL, NULL},
+    {"firstfit", firstfit_backend, firstfit_backend_free,
+     firstfit_backend_usage, heap_firstfit_reset_peak},
+    {"bestfit",  bestfit_backend,  bestfit_backend_free,
+     bestfit_backend_usage, heap_bestfit_reset_peak},
+    {"classes",  classes_backend,  classes_backend_free,
+     classes_backend_usage, heap_classes_reset_peak},
+    {"sidemeta", sidemeta_backend, sidemeta_backend_free,
+     sidemeta_backend_usage, heap_sidemeta_reset_peak},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+#define MAX_LOADED 8
+
+static allocator_t loaded_allocators[MAX_LOADED];
+static char loaded_names[MAX_LOADED][256];
+static int loaded_count = 0;
+
+// Load "LIB[:MALLOC,FREE]" with dlopen(). The library is opened with
+// RTLD_LOCAL so it does not interpose on the process's own malloc.
+static const allocator_t *load_allocator(const char *spec) {
+    char lib[256];
+    char malloc_sym[64] = "malloc";
+    char free_sym[64] = "free";
+
+    if (loaded_count == MAX_LOADED) {
+        fprintf(stderr, "allocators: too many dlopen backends\n");
+        return NULL;
+    }
+
+    const char *colon = strchr(spec, ':');
+    size_t lib_len = colon ? (size_t)(colon - spec) : strlen(spec);
+    if (lib_len == 0 || lib_len >= sizeof(lib)) {
+        fprintf(stderr, "allocators: bad library in '%s'\n", spec);
+        return NULL;
+    }
+    memcpy(lib, spec, lib_len);
+    lib[lib_len] = '\0';
+
+    if (colon != NULL && sscanf(colon + 1, "%63[^,],%63s", malloc_sym, free_sym) != 2) {
+        fprintf(stderr, "allocators: expected MALLOC,FREE symbols in '%s'\n", spec);
+        return NULL;
+    }
+
+    void *handle = dlopen(lib, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        fprintf(stderr, "allocators: %s\n", dlerror());
+        return NULL;
+    }
+
+    allocator_t *a = &loaded_allocators[loaded_count];
+    *(void **)&a->malloc = dlsym(handle, malloc_sym);
+    *(void **)&a->free = dlsym(handle, free_sym);
+    if (a->malloc == NULL || a->free == NULL) {
+        fprintf(stderr, "allocators: %s does not export %s/%s\n", lib, malloc_sym, free_sym);
+        dlclose(handle);
+        return NULL;
+    }
+
+    snprintf(loaded_names[loaded_count], sizeof(loaded_names[0]), "%s", lib);
+    a->name = loaded_names[loaded_count];
+    loaded_count++;
+    return a;
+}
+
+const allocator_t *find_allocator(const char *spec) {
+    if (strncmp(spec, "dlopen:", 7) == 0) {
+        return load_allocator(spec + 7);
+    }
+    for (int i = 0; builtin_allocators[i].name != NULL; i++) {
+        if (strcmp(builtin_allocators[i].name, spec) == 0) {
+            return &builtin_allocators[i];
+        }
+    }
+    fprintf(stderr, "allocators: unknown allocator '%s'\n", spec);
+    return NULL;
+}
+
+// Accounting wrapper: an open-addressing table from pointer to requested
+// size, kept in system memory and grown when half full
+typedef struct live_entry {
+    void *ptr;
+    size_t size;
+} live_entry_t;
+
+#define TOMBSTONE ((void *)1)
+
+static const allocator_t *accounted;
+static live_entry_t *live_table;
+static size_t live_capacity;
+static size_t live_used;
+static size_t live_bytes;
+static size_t peak_bytes;
+
+static size_t slot_of(void *ptr) {
+    uintptr_t h = (uintptr_t)ptr;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h & (live_capacity - 1);
+}
+
+static void live_insert(void *ptr, size_t size);
+
+static void live_grow(void) {
+    live_entry_t *old = live_table;
+    size_t old_capacity = live_capacity;
+
+    live_capacity = old_capacity ? old_capacity * 2 : 1024;
+    live_table = calloc(live_capacity, sizeof(live_entry_t));
+    if (live_table == NULL) {
+        fprintf(stderr, "allocators: unable to grow accounting table\n");
+        exit(1);
+    }
+    live_used = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old[i].ptr != NULL && old[i].ptr != TOMBSTONE) {
+            live_insert(old[i].ptr, old[i].size);
+        }
+    }
+    free(old);
+}
+
+static void live_insert(void *ptr, size_t size) {
+    if ((live_used + 1) * 2 > live_capacity) {
+        live_grow();
+    }
+    size_t i = slot_of(ptr);
+    while (live_table[i].ptr != NULL && live_table[i].ptr != TOMBSTONE) {
+        i = (i + 1) & (live_capacity - 1);
+    }
+    if (live_table[i].ptr == NULL) live_used++;
+    live_table[i].ptr = ptr;
+    live_table[i].size = size;
+}
+
+static void *accounting_malloc(size_t size) {
+    void *ptr = accounted->malloc(size);
+    if (ptr != NULL) {
+        live_insert(ptr, size);
+        live_bytes += size;
+        if (live_bytes > peak_bytes) peak_bytes = live_bytes;
+    }
+    return ptr;
+}
+
+static void accounting_free(void *ptr) {
+    if (ptr != NULL && live_capacity > 0) {
+        size_t i = slot_of(ptr);
+        while (live_table[i].ptr != NULL) {
+            if (live_table[i].ptr == ptr) {
+                live_bytes -= live_table[i].size;
+                live_table[i].ptr = TOMBSTONE;
+                break;
+            }
+            i = (i + 1) & (live_capacity - 1);
+        }
+    }
+    accounted->free(ptr);
+}
+
+const allocator_t *accounting_allocator(const allocator_t *inner) {
+    static allocator_t wrapper = {"accounting", accounting_malloc, accounting_free, NULL, NULL};
+
+    free(live_table);
+    live_table = NULL;
+    live_capacity = 0;
+    live_used = 0;
+    live_bytes = 0;
+    peak_bytes = 0;
+    accounted = inner;
+    return &wrapper;
+}
+
+size_t accounting_peak_bytes(void) {
+    return peak_bytes;
+}
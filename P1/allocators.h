@@ -0,0 +1,50 @@
+/**
+ *
+ * allocators.h: Pluggable allocator backends for the benchmarks
+ *
+ * The workloads call malloc/free through an allocator_t so the same binary
+ * can be run against mymalloc, the system malloc, or any allocator loaded
+ * from a shared object. Backends are named by a spec string:
+ *
+ *   mymalloc                      this project's allocator (the default)
+ *   system                        the C library malloc/free
+ *   firstfit, bestfit, classes,   heaps built from the heap.hpp template
+ *   sidemeta                      (see heaps.h)
+ *   dlopen:LIB[:MALLOC,FREE]      malloc/free loaded from LIB with dlopen();
+ *                                 the symbol names default to malloc,free
+ *
+ * For example "dlopen:libjemalloc.so.2" or
+ * "dlopen:libtcmalloc.so.4:tc_malloc,tc_free".
+ */
+
+#ifndef ALLOCATORS_H
+#define ALLOCATORS_H
+
+#include <stddef.h>
+
+// Footprint as seen by the allocator itself; see mymalloc_stats_t
+typedef struct allocator_usage {
+    size_t peak_requested;  // High-water mark of bytes requested
+    size_t peak_held;       // High-water mark of heap bytes in use
+    size_t heap_size;       // Size of the heap it allocates from
+} allocator_usage_t;
+
+typedef struct allocator {
+    const char *name;
+    void *(*malloc)(size_t size);
+    void (*free)(void *ptr);
+    // Optional, NULL when the allocator has no counters of its own
+    void (*usage)(allocator_usage_t *usage);
+    void (*reset_peak)(void);
+} allocator_t;
+
+// Resolve a backend spec; prints a message and returns NULL on failure
+const allocator_t *find_allocator(const char *spec);
+
+// Wrap `inner` so that every live allocation is tracked with its requested
+// size. Used for an untimed pass that measures the peak live bytes of a
+// workload independently of the allocator's own bookkeeping.
+const allocator_t *accounting_allocator(const allocator_t *inner);
+size_t accounting_peak_bytes(void);
+
+#endif
@@ -0,0 +1,155 @@
+/**
+ *
+ * baseline.c: Stored benchmark baselines and the regression test against them
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "baseline.h"
+
+int baseline_write(const char *path, const baseline_entry_t *entries, int n) {
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    fprintf(out, "# memgrind baseline: allocator workload ops nsamples ns/op...\n");
+    for (int i = 0; i < n; i++) {
+        const baseline_entry_t *e = &entries[i];
+        fprintf(out, "%s %s %ld %d", e->allocator, e->workload, e->ops, e->nsamples);
+        for (int s = 0; s < e->nsamples; s++) {
+            fprintf(out, " %.3f", e->samples[s]);
+        }
+        fprintf(out, "\n");
+    }
+    return fclose(out);
+}
+
+baseline_entry_t *baseline_read(const char *path, int *n) {
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    baseline_entry_t *entries = NULL;
+    int count = 0, capacity = 0;
+    char word[BASELINE_NAME_MAX];
+
+    while (fscanf(in, "%63s", word) == 1) {
+        if (word[0] == '#') {
+            int c;
+            while ((c = fgetc(in)) != EOF && c != '\n') {}
+            continue;
+        }
+
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            entries = realloc(entries, capacity * sizeof(*entries));
+        }
+        baseline_entry_t *e = &entries[count];
+        strcpy(e->allocator, word);
+        e->samples = NULL;
+
+        if (fscanf(in, "%63s %ld %d", e->workload, &e->ops, &e->nsamples) != 3
+            || e->nsamples <= 0) {
+            goto malformed;
+        }
+        e->samples = malloc(e->nsamples * sizeof(double));
+        count++;
+        for (int s = 0; s < e->nsamples; s++) {
+            if (fscanf(in, "%lf", &e->samples[s]) != 1) goto malformed;
+        }
+    }
+
+    fclose(in);
+    *n = count;
+    return entries;
+
+malformed:
+    fprintf(stderr, "%s: malformed baseline entry %d\n", path, count + 1);
+    fclose(in);
+    baseline_free(entries, count);
+    return NULL;
+}
+
+void baseline_free(baseline_entry_t *entries, int n) {
+    for (int i = 0; i < n; i++) {
+        free(entries[i].samples);
+    }
+    free(entries);
+}
+
+const baseline_entry_t *baseline_find(const baseline_entry_t *entries, int n,
+                                      const char *allocator, const char *workload) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(entries[i].allocator, allocator) == 0
+            && strcmp(entries[i].workload, workload) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+typedef struct ranked {
+    double value;
+    int group;     // 0 for a, 1 for b
+} ranked_t;
+
+static int compare_ranked(const void *x, const void *y) {
+    double a = ((const ranked_t *)x)->value, b = ((const ranked_t *)y)->value;
+    return (a > b) - (a < b);
+}
+
+double mann_whitney_p(const double *a, int na, const double *b, int nb) {
+    int n = na + nb;
+    ranked_t *all = malloc(n * sizeof(*all));
+
+    for (int i = 0; i < na; i++) all[i] = (ranked_t){a[i], 0};
+    for (int i = 0; i < nb; i++) all[na + i] = (ranked_t){b[i], 1};
+    qsort(all, n, sizeof(*all), compare_ranked);
+
+    // Sum the ranks of b, giving tied values the average of their ranks
+    double rank_sum = 0.0, ties = 0.0;
+    for (int i = 0; i < n; ) {
+        int j = i;
+        while (j < n && all[j].value == all[i].value) j++;
+        double rank = (i + 1 + j) / 2.0;
+        for (int k = i; k < j; k++) {
+            if (all[k].group == 1) rank_sum += rank;
+        }
+        double t = j - i;
+        ties += t * t * t - t;
+        i = j;
+    }
+    free(all);
+
+    double u = rank_sum - nb * (nb + 1) / 2.0;
+    double mean = na * (double)nb / 2.0;
+    double variance = na * (double)nb / 12.0 * ((n + 1) - ties / ((double)n * (n - 1)));
+    if (variance <= 0.0) {
+        return 1.0;  // Every sample identical
+    }
+
+    // Continuity correction towards the mean
+    double z = (u - mean - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+static int compare_double(const void *x, const void *y) {
+    double a = *(const double *)x, b = *(const double *)y;
+    return (a > b) - (a < b);
+}
+
+double sample_median(const double *samples, int n) {
+    double *sorted = malloc(n * sizeof(double));
+    memcpy(sorted, samples, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), compare_double);
+
+    double median = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+    free(sorted);
+    return median;
+}
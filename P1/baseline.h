@@ -0,0 +1,58 @@
+/**
+ *
+ * baseline.h: Stored benchmark baselines and the regression test against them
+ *
+ * A baseline keeps every per-run sample (nanoseconds per operation) for each
+ * allocator and workload, not just the average, so a later run can be
+ * compared with a Mann-Whitney U test instead of by eye. The test makes no
+ * assumption about the shape of the timing distribution, which is usually
+ * skewed by the occasional interrupted run.
+ *
+ * The file is plain text, one line per allocator and workload:
+ *
+ *   ALLOCATOR WORKLOAD OPS NSAMPLES SAMPLE...
+ *
+ * where OPS is the number of operations per run. Lines starting with '#' are
+ * comments.
+ */
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#define BASELINE_NAME_MAX 64
+
+// A slowdown is reported when it is significant at this level...
+#define BASELINE_ALPHA 0.01
+// ...and the median slowed down by more than this fraction (default 5%)
+#define BASELINE_MIN_SLOWDOWN 0.05
+
+typedef struct baseline_entry {
+    char allocator[BASELINE_NAME_MAX];
+    char workload[BASELINE_NAME_MAX];
+    long ops;            // Operations per run
+    int nsamples;
+    double *samples;     // Nanoseconds per operation, one per run
+} baseline_entry_t;
+
+// Write `n` entries to `path`. Returns 0 on success, -1 (with a message)
+// on failure.
+int baseline_write(const char *path, const baseline_entry_t *entries, int n);
+
+// Read a baseline file, returning an array of entries and its length in
+// `*n`, or NULL (with a message) on failure. Free with baseline_free().
+baseline_entry_t *baseline_read(const char *path, int *n);
+void baseline_free(baseline_entry_t *entries, int n);
+
+// Find the entry for an allocator and workload, or NULL
+const baseline_entry_t *baseline_find(const baseline_entry_t *entries, int n,
+                                      const char *allocator, const char *workload);
+
+// One-sided Mann-Whitney U test: the p-value for the hypothesis that samples
+// in `b` tend to be larger than those in `a`. Uses the normal approximation
+// with a tie correction, which is adequate from about five samples each.
+double mann_whitney_p(const double *a, int na, const double *b, int nb);
+
+// Median of `n` samples (the array is left untouched)
+double sample_median(const double *samples, int n);
+
+#endif
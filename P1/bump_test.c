@@ -0,0 +1,143 @@
+/**
+ *
+ * bump_test.c: Tests for the bump fast path (-DBUMP)
+ *
+ * Checks that a thread's region goes back to the heap after the thread
+ * exits, straight away if nothing in it is live and otherwise when its last
+ * object is freed, and that a thread whose region could not be claimed
+ * stops retrying for BUMP_CLAIM_RETRY small requests. Each test prints
+ * PASSED or FAILED; the program exits with status 1 if any test failed.
+ *
+ * "./bump_test interior" frees a pointer into the middle of a bump object
+ * whose first word looks like a bump object's state; it must be rejected
+ * like any other bad pointer, with exit status 2.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "mymalloc.h"
+
+// As in mymalloc.c
+#ifndef MEMLENGTH
+#define MEMLENGTH 4096
+#endif
+#ifndef BUMP_CLAIM_RETRY
+#define BUMP_CLAIM_RETRY 256
+#endif
+
+#define HEADER 16
+#define CHUNK_ALLOCATED 1
+#define CHUNK_BUMP_OBJECT 3
+
+static int failures = 0;
+static void *shared;
+static int shared_state;
+
+static void report(const char *test, int ok) {
+    printf("%s test %s\n", test, ok ? "PASSED" : "FAILED");
+    if (!ok) failures++;
+}
+
+// The state field of the header in front of an object
+static int header_state(void *ptr) {
+    return ((unsigned short *)ptr)[-4];
+}
+
+// Whether the whole heap is one free chunk again
+static int heap_empty(void) {
+    void *all = malloc(MEMLENGTH - HEADER);
+    free(all);
+    return all != NULL && mymalloc_check() == 0;
+}
+
+static void *alloc_and_free(void *arg) {
+    void *p = malloc(16);
+    shared = p;
+    shared_state = p != NULL ? header_state(p) : 0;
+    free(p);
+    return NULL;
+}
+
+static void *alloc_and_keep(void *arg) {
+    shared = malloc(16);
+    return NULL;
+}
+
+static void run_thread(void *(*body)(void *)) {
+    pthread_t thread;
+    pthread_create(&thread, NULL, body, NULL);
+    pthread_join(thread, NULL);
+}
+
+static void test_exit_empty(void) {
+    mymalloc_reset();
+    run_thread(alloc_and_free);
+    report("Region released at thread exit",
+           shared_state == CHUNK_BUMP_OBJECT && heap_empty());
+}
+
+static void test_exit_live(void) {
+    mymalloc_reset();
+    run_thread(alloc_and_keep);
+    int ok = shared != NULL && mymalloc_check() == 0;
+    free(shared);
+    report("Region released by its last free", ok && heap_empty());
+}
+
+// Leave less than a region free, so the thread's claim fails
+static void *claim_fails(void *big) {
+    int ok = 1;
+
+    void *p = malloc(16);
+    ok = ok && p != NULL && header_state(p) == CHUNK_ALLOCATED;
+    free(p);
+    free(big);
+
+    // Room for a region now, but the failure is remembered
+    for (int i = 0; i < BUMP_CLAIM_RETRY; i++) {
+        p = malloc(16);
+        ok = ok && p != NULL && header_state(p) == CHUNK_ALLOCATED;
+        free(p);
+    }
+    p = malloc(16);
+    ok = ok && p != NULL && header_state(p) == CHUNK_BUMP_OBJECT;
+    free(p);
+    return ok ? big : NULL;
+}
+
+static void test_claim_backoff(void) {
+    pthread_t thread;
+    void *result;
+
+    mymalloc_reset();
+    void *big = malloc(MEMLENGTH - 2 * HEADER - 256);
+    pthread_create(&thread, NULL, claim_fails, big);
+    pthread_join(thread, &result);
+    report("Failed claim backoff", big != NULL && result == big && heap_empty());
+}
+
+static void free_interior(void) {
+    int *p = malloc(40);
+    p[0] = CHUNK_BUMP_OBJECT;
+    free(p + 2);
+    printf("ERROR: Program did not terminate after freeing an interior pointer\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "interior") == 0) {
+        free_interior();
+        return 1;
+    }
+
+    test_exit_empty();
+    test_exit_live();
+    test_claim_backoff();
+
+    if (failures > 0) {
+        printf("%d bump tests FAILED\n", failures);
+        return 1;
+    }
+    printf("All bump tests passed\n");
+    return 0;
+}
@@ -0,0 +1,35 @@
+/**
+ *
+ * callsite.h: Compact call-site descriptors for the allocator entry points
+ *
+ * MM_SITE() evaluates to a pointer to a static descriptor holding the
+ * caller's __FILE__ and __LINE__, one per call site. The allocators take
+ * that single pointer instead of a file and a line, and only read it on
+ * error and reporting paths.
+ *
+ * mymalloc.c also interns each site the first time it allocates, caching a
+ * small id in the descriptor so a chunk can record where it came from (see
+ * the leak report). Without GNU statement expressions the descriptor is a
+ * compound literal, which is not static; such sites are marked transient
+ * and are reported with their file and line on errors but not interned.
+ */
+
+#ifndef CALLSITE_H
+#define CALLSITE_H
+
+#define MM_SITE_TRANSIENT 0xffff  // id of a descriptor that may not outlive the call
+
+typedef struct mm_site {
+    const char *file;
+    int line;
+    unsigned short id;  // Interned id, 0 until first use
+} mm_site_t;
+
+#if defined(__GNUC__)
+#define MM_SITE() \
+    ({ static mm_site_t mm_site_ = { __FILE__, __LINE__, 0 }; &mm_site_; })
+#else
+#define MM_SITE() (&(mm_site_t){ __FILE__, __LINE__, MM_SITE_TRANSIENT })
+#endif
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ *
+ * cxxbench.cpp: Standard containers on mymalloc through mymalloc.hpp
+ *
+ * Times std::pmr::vector, std::pmr::map and std::pmr::string workloads on
+ * each memory resource in turn:
+ *
+ *   default    std::pmr::new_delete_resource() (the C++ runtime's heap)
+ *   mymalloc   mm::resource(), every allocation goes to mymalloc
+ *   pool       mm::pool_resource, size-class pools on top of mymalloc
+ *   monotonic  mm::monotonic_resource, bump allocation on top of mymalloc
+ *
+ * and also runs the vector workload with the mm::allocator template. Every
+ * run checks the container contents, and once the containers are destroyed
+ * the mymalloc heap must be empty again; any mismatch prints FAILED and the
+ * program exits with status 1.
+ *
+ * Usage: ./cxxbench [-n ELEMENTS] [-r RUNS]
+ *
+ * The defaults (16 elements, 1000 runs) fit in the default 4096 byte heap;
+ * rebuild with "make MEMLENGTH=<bytes>" for larger element counts.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "mymalloc.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char *what, const char *resource) {
+    if (!ok) {
+        std::printf("FAILED: %s on %s\n", what, resource);
+        failures++;
+    }
+}
+
+// Each workload builds a container, checks it and returns a checksum
+long vector_workload(std::pmr::memory_resource *r, int n) {
+    std::pmr::vector<long> v(r);
+    for (int i = 0; i < n; i++) v.push_back(i * 3);
+    long sum = 0;
+    for (long x : v) sum += x;
+    return sum;
+}
+
+long map_workload(std::pmr::memory_resource *r, int n) {
+    std::pmr::map<int, long> m(r);
+    for (int i = 0; i < n; i++) m.emplace((i * 7919) % n, i);
+    for (int i = 0; i < n; i += 2) m.erase(i);
+    long sum = 0;
+    for (const auto &entry : m) sum += entry.first;
+    return sum;
+}
+
+long string_workload(std::pmr::memory_resource *r, int n) {
+    std::pmr::vector<std::pmr::string> words(r);
+    for (int i = 0; i < n / 2; i++) {
+        words.emplace_back("a string too long for the small buffer ");
+        words.back() += std::to_string(i);
+    }
+    long sum = 0;
+    for (const auto &w : words) sum += w.size();
+    return sum;
+}
+
+long allocator_workload(int n) {
+    std::vector<long, mm::allocator<long>> v;
+    for (int i = 0; i < n; i++) v.push_back(i * 3);
+    long sum = 0;
+    for (long x : v) sum += x;
+    return sum;
+}
+
+size_t heap_in_use() {
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    return stats.held;
+}
+
+template <typename Workload>
+void run(const char *name, const char *resource, Workload workload, long expected, int runs) {
+    long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        for (int i = 0; i < runs; i++) {
+            checksum = workload();
+            check(checksum == expected, name, resource);
+        }
+    } catch (const std::bad_alloc &) {
+        std::printf("%-10s %-10s skipped: heap too small (rebuild with a larger MEMLENGTH)\n",
+                    name, resource);
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    double us = std::chrono::duration<double, std::micro>(end - start).count() / runs;
+    std::printf("%-10s %-10s %10.2f us per run\n", name, resource, us);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    int n = 16;
+    int runs = 1000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+        case 'n': n = std::atoi(optarg); break;
+        case 'r': runs = std::atoi(optarg); break;
+        default:
+            std::fprintf(stderr, "Usage: %s [-n ELEMENTS] [-r RUNS]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (n < 2 || runs <= 0) {
+        std::fprintf(stderr, "Usage: %s [-n ELEMENTS] [-r RUNS]\n", argv[0]);
+        return 2;
+    }
+
+    // Reference results from the default resource
+    auto *system = std::pmr::new_delete_resource();
+    long vector_sum = vector_workload(system, n);
+    long map_sum = map_workload(system, n);
+    long string_sum = string_workload(system, n);
+
+    std::printf("C++ containers, %d elements, %d runs\n", n, runs);
+    std::printf("%-10s %-10s %10s\n", "Workload", "Resource", "time");
+
+    struct {
+        const char *name;
+        long expected;
+        long (*workload)(std::pmr::memory_resource *, int);
+    } workloads[] = {
+        {"vector", vector_sum, vector_workload},
+        {"map", map_sum, map_workload},
+        {"string", string_sum, string_workload},
+    };
+
+    for (const auto &w : workloads) {
+        run(w.name, "default", [&] { return w.workload(system, n); }, w.expected, runs);
+        run(w.name, "mymalloc", [&] { return w.workload(mm::resource(), n); }, w.expected, runs);
+        run(w.name, "pool", [&] {
+            mm::pool_resource pool;
+            return w.workload(&pool, n);
+        }, w.expected, runs);
+        run(w.name, "monotonic", [&] {
+            mm::monotonic_resource arena;
+            return w.workload(&arena, n);
+        }, w.expected, runs);
+        check(heap_in_use() == 0, "heap not empty after the containers were destroyed", w.name);
+    }
+    run("vector", "allocator", [&] { return allocator_workload(n); }, vector_sum, runs);
+    check(heap_in_use() == 0, "heap not empty after the containers were destroyed", "allocator");
+
+    if (failures > 0) {
+        std::printf("%d checks FAILED\n", failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+/**
+ *
+ * fuzz_corpus.c: Seed corpus for fuzz_target built from the memgrind workloads
+ *
+ * Runs each workload once against a recording allocator that encodes every
+ * malloc/free as a fuzz_ops.h operation, and writes one input file per
+ * workload into the given directory. The objects themselves come from the
+ * system allocator, so the recording does not depend on the heap size.
+ *
+ * Usage: ./fuzz_corpus DIR
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fuzz_ops.h"
+#include "workloads.h"
+
+#define MAX_INPUT 65536
+
+static const allocator_t *backing;
+static void *slot_ptrs[FUZZ_SLOTS];
+static unsigned char input[MAX_INPUT];
+static size_t input_length;
+static int truncated;
+
+static void emit(const unsigned char *op, size_t length) {
+    if (truncated || input_length + length > MAX_INPUT) {
+        truncated = 1;
+        return;
+    }
+    memcpy(input + input_length, op, length);
+    input_length += length;
+}
+
+static void *recording_malloc(size_t size) {
+    void *ptr = backing->malloc(size);
+    if (ptr == NULL) return NULL;
+
+    // Objects beyond the slot table are allocated but not recorded
+    for (int slot = 0; slot < FUZZ_SLOTS; slot++) {
+        if (slot_ptrs[slot] == NULL) {
+            size_t n = size > 0xFFFF ? 0xFFFF : size;
+            unsigned char op[4] = {FUZZ_OP_MALLOC, slot, n & 0xFF, n >> 8};
+            slot_ptrs[slot] = ptr;
+            emit(op, sizeof(op));
+            break;
+        }
+    }
+    return ptr;
+}
+
+static void recording_free(void *ptr) {
+    for (int slot = 0; ptr != NULL && slot < FUZZ_SLOTS; slot++) {
+        if (slot_ptrs[slot] == ptr) {
+            unsigned char op[2] = {FUZZ_OP_FREE, slot};
+            slot_ptrs[slot] = NULL;
+            emit(op, sizeof(op));
+            break;
+        }
+    }
+    backing->free(ptr);
+}
+
+int main(int argc, char *argv[]) {
+    static allocator_t recorder = {"recorder", recording_malloc, recording_free, NULL, NULL};
+    workload_params_t params = {0, 0, 1};
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s DIR\n", argv[0]);
+        return 2;
+    }
+    backing = find_allocator("system");
+
+    for (int i = 0; workloads[i].name != NULL; i++) {
+        workload_result_t result;
+        char path[4096];
+
+        memset(slot_ptrs, 0, sizeof(slot_ptrs));
+        input_length = 0;
+        truncated = 0;
+        run_workload(&workloads[i], &recorder, &params, &result);
+
+        snprintf(path, sizeof(path), "%s/%s", argv[1], workloads[i].name);
+        FILE *out = fopen(path, "wb");
+        if (out == NULL || fwrite(input, 1, input_length, out) != input_length) {
+            perror(path);
+            return 1;
+        }
+        fclose(out);
+        printf("%-9s %6zu bytes%s\n", workloads[i].name, input_length,
+               truncated ? " (truncated)" : "");
+    }
+    return 0;
+}
@@ -0,0 +1,31 @@
+/**
+ *
+ * fuzz_ops.h: Byte encoding of allocator operations for the fuzz target
+ *
+ * An input is a sequence of operations, each an opcode byte followed by its
+ * arguments. Objects live in FUZZ_SLOTS numbered slots; sizes are 16-bit
+ * little-endian. Inputs that end in the middle of an operation are simply
+ * cut short, so every byte string is a valid input.
+ *
+ *   FUZZ_OP_MALLOC  slot size_lo size_hi    free the slot if used, then malloc
+ *   FUZZ_OP_FREE    slot                    free the slot if used
+ *   FUZZ_OP_REALLOC slot size_lo size_hi    realloc the slot (malloc if empty)
+ *   FUZZ_OP_CALLOC  slot count size         free the slot if used, then calloc
+ *
+ * The opcode is taken modulo FUZZ_NOPS.
+ */
+
+#ifndef FUZZ_OPS_H
+#define FUZZ_OPS_H
+
+enum {
+    FUZZ_OP_MALLOC,
+    FUZZ_OP_FREE,
+    FUZZ_OP_REALLOC,
+    FUZZ_OP_CALLOC,
+    FUZZ_NOPS
+};
+
+#define FUZZ_SLOTS 256
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ *
+ * fuzz_target.c: Coverage-guided fuzz target for mymalloc
+ *
+ * Decodes an input (see fuzz_ops.h) into malloc/free/realloc/calloc calls on
+ * a freshly reset heap and runs mymalloc_check() after every operation.
+ * Every object is filled with a pattern derived from its slot, and checked
+ * before it is freed or reallocated, so overlapping chunks are caught too.
+ * Any problem aborts, which the fuzzer records as a crash.
+ *
+ * With clang and libFuzzer (no network needed):
+ *
+ *   make fuzz-libfuzzer
+ *   make fuzz-corpus
+ *   ./fuzz_libfuzzer -close_fd_mask=2 corpus/
+ *
+ * -close_fd_mask=2 silences the "Unable to allocate" messages mymalloc prints
+ * for requests that do not fit. Without libFuzzer, "make fuzz_target" builds
+ * the same code with a main() that replays files or directories of inputs,
+ * which is handy for reproducing a crash or for AFL-style drivers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "fuzz_ops.h"
+#include "mymalloc.h"
+
+static unsigned char *slots[FUZZ_SLOTS];
+static size_t slot_sizes[FUZZ_SLOTS];
+
+static unsigned char pattern_byte(int slot, size_t offset) {
+    return (unsigned char)(slot * 7 + offset);
+}
+
+static void fill_slot(int slot, size_t from) {
+    for (size_t i = from; i < slot_sizes[slot]; i++) {
+        slots[slot][i] = pattern_byte(slot, i);
+    }
+}
+
+static void verify_slot(int slot, size_t upto) {
+    for (size_t i = 0; i < upto; i++) {
+        if (slots[slot][i] != pattern_byte(slot, i)) {
+            fprintf(stderr, "fuzz_target: slot %d corrupted at offset %zu\n", slot, i);
+            abort();
+        }
+    }
+}
+
+static void release_slot(int slot) {
+    if (slots[slot] == NULL) return;
+    verify_slot(slot, slot_sizes[slot]);
+    free(slots[slot]);
+    slots[slot] = NULL;
+    slot_sizes[slot] = 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    size_t pos = 0;
+
+    mymalloc_reset();
+    memset(slots, 0, sizeof(slots));
+    memset(slot_sizes, 0, sizeof(slot_sizes));
+
+    while (pos + 2 <= size) {
+        int op = data[pos] % FUZZ_NOPS;
+        int slot = data[pos + 1];
+        size_t n;
+
+        if (op != FUZZ_OP_FREE && pos + 4 > size) {
+            break;
+        }
+
+        switch (op) {
+        case FUZZ_OP_MALLOC:
+            n = data[pos + 2] | (data[pos + 3] << 8);
+            pos += 4;
+            release_slot(slot);
+            slots[slot] = malloc(n);
+            if (slots[slot] != NULL) {
+                slot_sizes[slot] = n;
+                fill_slot(slot, 0);
+            }
+            break;
+
+        case FUZZ_OP_FREE:
+            pos += 2;
+            release_slot(slot);
+            break;
+
+        case FUZZ_OP_REALLOC: {
+            n = data[pos + 2] | (data[pos + 3] << 8);
+            pos += 4;
+            size_t old_size = slot_sizes[slot];
+            if (slots[slot] != NULL) verify_slot(slot, old_size);
+            unsigned char *moved = realloc(slots[slot], n);
+            if (moved != NULL) {
+                slots[slot] = moved;
+                slot_sizes[slot] = n;
+                verify_slot(slot, old_size < n ? old_size : n);
+                fill_slot(slot, old_size < n ? old_size : n);
+            } else if (n == 0) {
+                // realloc(p, 0) frees p
+                slots[slot] = NULL;
+                slot_sizes[slot] = 0;
+            }
+            break;
+        }
+
+        case FUZZ_OP_CALLOC:
+            n = (size_t)data[pos + 2] * data[pos + 3];
+            release_slot(slot);
+            slots[slot] = calloc(data[pos + 2], data[pos + 3]);
+            pos += 4;
+            if (slots[slot] != NULL) {
+                for (size_t i = 0; i < n; i++) {
+                    if (slots[slot][i] != 0) {
+                        fprintf(stderr, "fuzz_target: calloc memory not zeroed\n");
+                        abort();
+                    }
+                }
+                slot_sizes[slot] = n;
+                fill_slot(slot, 0);
+            }
+            break;
+        }
+
+        if (mymalloc_check() != 0) {
+            abort();
+        }
+    }
+
+    for (int i = 0; i < FUZZ_SLOTS; i++) {
+        release_slot(i);
+    }
+    if (mymalloc_check() != 0) {
+        abort();
+    }
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+#include <dirent.h>
+#include <sys/stat.h>
+
+// Replay one input file
+static int run_file(const char *path) {
+    FILE *in = fopen(path, "rb");
+    if (in == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    static uint8_t buffer[1 << 20];
+    size_t length = fread(buffer, 1, sizeof(buffer), in);
+    fclose(in);
+
+    LLVMFuzzerTestOneInput(buffer, length);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int failures = 0;
+    int inputs = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s FILE|DIR...\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        struct stat st;
+        if (stat(argv[i], &st) == 0 && S_ISDIR(st.st_mode)) {
+            DIR *dir = opendir(argv[i]);
+            struct dirent *entry;
+            while (dir != NULL && (entry = readdir(dir)) != NULL) {
+                char path[4096];
+                if (entry->d_name[0] == '.') continue;
+                snprintf(path, sizeof(path), "%s/%s", argv[i], entry->d_name);
+                failures += run_file(path);
+                inputs++;
+            }
+            if (dir != NULL) closedir(dir);
+        } else {
+            failures += run_file(argv[i]);
+            inputs++;
+        }
+    }
+
+    printf("Replayed %d inputs, %d unreadable\n", inputs, failures);
+    return failures ? 1 : 0;
+}
+#endif
@@ -0,0 +1,283 @@
+/**
+ *
+ * fuzz_test.c: Randomized differential test of mymalloc against a shadow model
+ *
+ * This program drives the allocator with a long random mix of malloc, calloc,
+ * realloc and free calls with random sizes, and checks every result against
+ * a shadow model of what should be live:
+ *
+ * - Every returned pointer is 8-byte aligned
+ * - No live object overlaps another
+ * - Object contents survive other operations (each object is filled with a
+ *   pattern that is verified before it is freed and in periodic full sweeps)
+ * - realloc() preserves the old contents up to the smaller size, and calloc()
+ *   returns zeroed memory
+ * - The allocator's counters (see mymalloc_get_stats) agree with the model:
+ *   live count, bytes requested, held >= requested, and an empty heap once
+ *   everything is freed
+ * - An allocation of at most half the heap never fails on an empty heap
+ *
+ * The checks only rely on behaviour any correct allocator must have, not on
+ * where first-fit happens to place objects, so the test stays valid across
+ * rewrites of the placement policy.
+ *
+ * Usage: ./fuzz_test [-n OPS] [-t SECONDS] [-S SEED] [-v]
+ *
+ * The run stops after OPS operations (default 200000) or SECONDS seconds,
+ * whichever comes first; use "-n 0 -t 3600" for an hour-long soak. Build
+ * with optimizations (make clean && make CFLAGS="-O2 -g -Wall -Werror") for
+ * long runs. On a failure the seed and operation number are printed so the
+ * run can be reproduced, and the program exits with status 1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <time.h>
+#include "mymalloc.h"
+
+#define MAX_LIVE 65536
+#define SWEEP_INTERVAL 1024
+
+typedef struct shadow {
+    unsigned char *ptr;
+    size_t size;
+    unsigned char tag;     // Seeds the fill pattern
+} shadow_t;
+
+static shadow_t live[MAX_LIVE];
+static int nlive = 0;
+static size_t live_bytes = 0;
+
+static unsigned long seed;
+static long op_number = 0;
+static int verbose = 0;
+
+static unsigned long long rng_state;
+
+static unsigned long next_rand(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned long)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static void fail(const char *what, const void *ptr, size_t size) {
+    fflush(stdout);
+    fprintf(stderr, "fuzz_test: FAILED at op %ld (seed %lu): %s (ptr %p, size %zu)\n",
+            op_number, seed, what, ptr, size);
+    exit(1);
+}
+
+static unsigned char pattern_byte(unsigned char tag, size_t offset) {
+    return (unsigned char)(tag ^ (offset * 31) ^ (offset >> 8));
+}
+
+static void fill(shadow_t *s, size_t from) {
+    for (size_t i = from; i < s->size; i++) {
+        s->ptr[i] = pattern_byte(s->tag, i);
+    }
+}
+
+static void verify(const shadow_t *s, size_t upto) {
+    for (size_t i = 0; i < upto; i++) {
+        if (s->ptr[i] != pattern_byte(s->tag, i)) {
+            fail("object contents corrupted", s->ptr, s->size);
+        }
+    }
+}
+
+// Check a fresh allocation against every other live object
+static void check_placement(const unsigned char *ptr, size_t size, int skip) {
+    if ((uintptr_t)ptr % 8 != 0) {
+        fail("misaligned pointer", ptr, size);
+    }
+    for (int i = 0; i < nlive; i++) {
+        if (i == skip) continue;
+        if (ptr < live[i].ptr + live[i].size && live[i].ptr < ptr + size) {
+            fail("overlaps a live object", ptr, size);
+        }
+    }
+}
+
+static void check_accounting(void) {
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+
+    if (stats.mallocs - stats.frees != (size_t)nlive) {
+        fail("allocator live count disagrees with model", NULL, stats.mallocs - stats.frees);
+    }
+    if (stats.requested != live_bytes) {
+        fail("allocator requested bytes disagree with model", NULL, stats.requested);
+    }
+    if (stats.held < stats.requested || stats.held > stats.heap_size) {
+        fail("allocator held bytes out of range", NULL, stats.held);
+    }
+}
+
+// NULL is only acceptable if the heap could plausibly be full or fragmented
+static void check_failure(size_t size) {
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    if (nlive == 0 && size <= stats.heap_size / 2) {
+        fail("allocation failed on an empty heap", NULL, size);
+    }
+}
+
+// Mostly small power-law sizes, with the occasional large request
+static size_t random_size(size_t heap_size) {
+    if (next_rand() % 64 == 0) {
+        return 1 + next_rand() % (heap_size / 4);
+    }
+    size_t octave = 1;
+    while (octave < 256 && (next_rand() & 1)) {
+        octave *= 2;
+    }
+    return octave + next_rand() % octave;
+}
+
+static void add_live(unsigned char *ptr, size_t size) {
+    shadow_t *s = &live[nlive++];
+    s->ptr = ptr;
+    s->size = size;
+    s->tag = (unsigned char)next_rand();
+    live_bytes += size;
+    fill(s, 0);
+}
+
+static void remove_live(int index) {
+    live_bytes -= live[index].size;
+    live[index] = live[--nlive];
+}
+
+static void do_malloc(size_t size) {
+    unsigned char *ptr = malloc(size);
+    if (verbose) printf("%ld: malloc(%zu) = %p\n", op_number, size, (void *)ptr);
+    if (ptr == NULL) {
+        check_failure(size);
+        return;
+    }
+    check_placement(ptr, size, -1);
+    add_live(ptr, size);
+}
+
+static void do_calloc(size_t size) {
+    size_t count = 1 + next_rand() % 4;
+    size_t each = (size + count - 1) / count;
+    unsigned char *ptr = calloc(count, each);
+    if (verbose) printf("%ld: calloc(%zu, %zu) = %p\n", op_number, count, each, (void *)ptr);
+    if (ptr == NULL) {
+        check_failure(count * each);
+        return;
+    }
+    check_placement(ptr, count * each, -1);
+    for (size_t i = 0; i < count * each; i++) {
+        if (ptr[i] != 0) fail("calloc memory not zeroed", ptr, count * each);
+    }
+    add_live(ptr, count * each);
+}
+
+static void do_realloc(int index, size_t size) {
+    shadow_t *s = &live[index];
+    size_t old_size = s->size;
+
+    verify(s, old_size);
+    unsigned char *ptr = realloc(s->ptr, size);
+    if (verbose) printf("%ld: realloc(%p, %zu) = %p\n", op_number, (void *)s->ptr, size, (void *)ptr);
+    if (ptr == NULL) {
+        // The old object must be untouched
+        check_failure(size);
+        verify(s, old_size);
+        return;
+    }
+
+    check_placement(ptr, size, index);
+    s->ptr = ptr;
+    s->size = size;
+    live_bytes += size - old_size;
+    verify(s, old_size < size ? old_size : size);
+    if (size > old_size) fill(s, old_size);
+}
+
+static void do_free(int index) {
+    verify(&live[index], live[index].size);
+    if (verbose) printf("%ld: free(%p)\n", op_number, (void *)live[index].ptr);
+    free(live[index].ptr);
+    remove_live(index);
+}
+
+int main(int argc, char *argv[]) {
+    long max_ops = 200000;
+    long max_seconds = 0;
+    int opt;
+
+    seed = time(NULL);
+    while ((opt = getopt(argc, argv, "n:t:S:v")) != -1) {
+        switch (opt) {
+        case 'n': max_ops = atol(optarg); break;
+        case 't': max_seconds = atol(optarg); break;
+        case 'S': seed = strtoul(optarg, NULL, 0); break;
+        case 'v': verbose = 1; break;
+        default:
+            fprintf(stderr, "Usage: %s [-n OPS] [-t SECONDS] [-S SEED] [-v]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (max_ops <= 0 && max_seconds <= 0) {
+        fprintf(stderr, "fuzz_test: need a positive -n or -t\n");
+        return 2;
+    }
+
+    rng_state = seed ? seed : 1;
+    printf("Running randomized allocator test (seed %lu)...\n", seed);
+
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    time_t start = time(NULL);
+
+    for (op_number = 0; max_ops <= 0 || op_number < max_ops; op_number++) {
+        if (max_seconds > 0 && op_number % 4096 == 0 && time(NULL) - start >= max_seconds) {
+            break;
+        }
+
+        size_t size = random_size(stats.heap_size);
+        unsigned long choice = next_rand() % 100;
+
+        // Lean towards freeing as the heap fills up, so the run keeps cycling
+        // through full and empty states instead of failing every allocation
+        mymalloc_get_stats(&stats);
+        int full = stats.held + size + 64 > stats.heap_size * 3 / 4 || nlive == MAX_LIVE;
+
+        if (nlive > 0 && (full || choice < 35)) {
+            do_free(next_rand() % nlive);
+        } else if (nlive > 0 && choice < 55) {
+            do_realloc(next_rand() % nlive, size);
+        } else if (choice < 65) {
+            do_calloc(size);
+        } else {
+            do_malloc(size);
+        }
+
+        check_accounting();
+        if (op_number % SWEEP_INTERVAL == 0) {
+            for (int i = 0; i < nlive; i++) {
+                verify(&live[i], live[i].size);
+            }
+        }
+    }
+
+    while (nlive > 0) {
+        do_free(nlive - 1);
+    }
+    check_accounting();
+    mymalloc_get_stats(&stats);
+    if (stats.held != 0) {
+        fail("heap not empty after freeing everything", NULL, stats.held);
+    }
+
+    printf("Fuzz test PASSED - %ld operations (%zu mallocs, %zu frees, %zu failed) with seed %lu\n",
+           op_number, stats.mallocs, stats.frees, stats.failed, seed);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/**
+ *
+ * gen_size_classes.cpp: Emit the size-class tables as a C header
+ *
+ * The tables are computed at compile time with mm::spaced_classes from
+ * heap.hpp, so a table that is not strictly ascending or that wastes more
+ * than the bound fails the build rather than shipping. The program only
+ * prints what the compiler already computed:
+ *
+ *   size_class_payload[g]  payload for a request of up to g * ALIGN bytes
+ *   size_class_index[g]    index of that class in size_class_sizes
+ *   size_class_sizes[i]    the classes themselves
+ *
+ * so mymalloc.c (built with -DSIZE_CLASSES) rounds a small request with a
+ * single indexed load. The make rule regenerates size_classes.h:
+ *
+ *   ./gen_size_classes > size_classes.h
+ *
+ * Tuning: -DSIZE_CLASS_MAX=<bytes> (default 512) and
+ * -DSIZE_CLASS_WASTE=<percent> (default 25).
+ */
+
+#include <cstdio>
+#include "heap.hpp"
+
+#ifndef SIZE_CLASS_ALIGN
+#define SIZE_CLASS_ALIGN 8
+#endif
+
+#ifndef SIZE_CLASS_MAX
+#define SIZE_CLASS_MAX 512
+#endif
+
+#ifndef SIZE_CLASS_WASTE
+#define SIZE_CLASS_WASTE 25
+#endif
+
+using classes = mm::spaced_classes<SIZE_CLASS_ALIGN, SIZE_CLASS_MAX, SIZE_CLASS_WASTE>;
+
+// mymalloc's smallest payload is one alignment unit
+constexpr auto payload = mm::class_table<classes, SIZE_CLASS_ALIGN, SIZE_CLASS_ALIGN>();
+
+constexpr std::array<std::size_t, payload.size()> build_index() {
+    std::array<std::size_t, payload.size()> index{};
+    for (std::size_t g = 0; g < payload.size(); g++) {
+        while (classes::sizes[index[g]] < payload[g]) index[g]++;
+    }
+    return index;
+}
+
+constexpr auto index = build_index();
+
+static_assert(classes::count <= 255, "class indices must fit in an unsigned char");
+static_assert(classes::largest() <= 65535, "classes must fit in an unsigned short");
+
+// Every request maps to a class that holds it, and no larger one than needed
+constexpr bool table_is_tight() {
+    for (std::size_t g = 1; g < payload.size(); g++) {
+        std::size_t bytes = g * SIZE_CLASS_ALIGN;
+        if (payload[g] < bytes) return false;
+        if (index[g] > 0 && classes::sizes[index[g] - 1] >= bytes) return false;
+        if (payload[g] < payload[g - 1]) return false;
+    }
+    return true;
+}
+static_assert(table_is_tight());
+
+template <std::size_t N>
+void print_table(const char *type, const char *name, const std::array<std::size_t, N> &values) {
+    std::printf("SIZE_CLASS_TABLE %s %s[%zu] = {", type, name, N);
+    for (std::size_t i = 0; i < N; i++) {
+        std::printf("%s%zu%s", i % 16 == 0 ? "\n    " : " ", values[i], i + 1 < N ? "," : "");
+    }
+    std::printf("\n};\n\n");
+}
+
+int main() {
+    std::printf("/* size_classes.h: generated by gen_size_classes, do not edit */\n\n");
+    std::printf("#ifndef SIZE_CLASSES_H\n#define SIZE_CLASSES_H\n\n");
+    std::printf("#define SIZE_CLASS_ALIGN %d\n", SIZE_CLASS_ALIGN);
+    std::printf("#define SIZE_CLASS_MAX %d\n", SIZE_CLASS_MAX);
+    std::printf("#define SIZE_CLASS_COUNT %zu\n", classes::count);
+    std::printf("#define SIZE_CLASS_WORST_WASTE %zu  /* percent */\n\n",
+                mm::worst_waste_percent(classes::sizes, SIZE_CLASS_ALIGN));
+    std::printf("/* Not every includer uses every table */\n");
+    std::printf("#ifdef __GNUC__\n#define SIZE_CLASS_TABLE static const __attribute__((unused))\n");
+    std::printf("#else\n#define SIZE_CLASS_TABLE static const\n#endif\n\n");
+
+    print_table("unsigned short", "size_class_sizes", classes::sizes);
+    std::printf("/* Indexed by (size + SIZE_CLASS_ALIGN - 1) / SIZE_CLASS_ALIGN */\n");
+    print_table("unsigned short", "size_class_payload", payload);
+    print_table("unsigned char", "size_class_index", index);
+
+    std::printf("#endif\n");
+    return 0;
+}
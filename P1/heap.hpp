@@ -0,0 +1,518 @@
+/**
+ *
+ * heap.hpp: Compile-time configured heaps
+ *
+ * mymalloc.c is configured with preprocessor constants (MEMLENGTH, ALIGNMENT,
+ * MIN_CHUNK_SIZE) and has its first-fit placement written into the code, so
+ * a binary gets exactly one heap. This header makes the same chunk design a
+ * template:
+ *
+ *   mm::Heap<Capacity, Align, Policy, SizeClasses, Layout>
+ *
+ *   Capacity     heap size in bytes (a multiple of Align)
+ *   Align        payload alignment, a power of two of at least 8
+ *   Policy       mm::first_fit (take the first free chunk that fits) or
+ *                mm::best_fit (take the smallest one, stopping at an exact fit)
+ *   SizeClasses  mm::size_classes<S1, S2, ...> rounds every request up to the
+ *                next class, so freed chunks are reused exactly; requests
+ *                above the largest class are only rounded to Align. The
+ *                default, mm::size_classes<>, rounds everything to Align.
+ *                mm::spaced_classes<Align, Largest, MaxWastePercent>
+ *                generates the classes instead, as few as possible while
+ *                wasting at most MaxWastePercent of a chunk.
+ *   Layout       mm::inline_headers (the default) puts each chunk's header in
+ *                front of its payload, as mymalloc does. mm::out_of_band
+ *                keeps the headers in arrays beside the payload area
+ *                instead, one entry per Align-byte granule (see below).
+ *
+ * All of these are constexpr: the policy branch not taken is compiled out,
+ * and the size-class lookup is a table built at compile time and indexed by
+ * the request size in Align units. Each instance owns its storage, so
+ * differently tuned heaps can live side by side; heaps.h exposes a few to C.
+ *
+ * Like mymalloc, a heap is a sequence of chunks, each a header followed by
+ * its payload. Free chunks are merged with free neighbours on every free,
+ * and deallocate() checks the pointer by walking the heap to it, reporting
+ * bad pointers as a free_status instead of exiting. Not thread-safe.
+ *
+ * With mm::out_of_band the payloads are packed with no headers between
+ * them. A dense array holds one tag word per granule: at a chunk's first
+ * granule, its size in granules plus an allocated bit, and 0 everywhere
+ * else. The search and check() walk that array and never touch payload
+ * memory. With 8-byte granules the array is half the size of the heap,
+ * and for 16-byte objects a walk covers a quarter of the bytes it covers
+ * with inline headers. An overrun past the end of a payload can no longer
+ * corrupt a header.
+ * Because every granule has an entry, deallocate() validates a pointer
+ * with one lookup instead of a walk. It finds the previous chunk for
+ * coalescing in a second, cold array, which the search never reads. The
+ * tables cost 12 bytes per granule, stored next to the heap.
+ */
+
+#ifndef HEAP_HPP
+#define HEAP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace mm {
+
+struct first_fit {};
+struct best_fit {};
+
+struct inline_headers {};
+struct out_of_band {};
+
+// Checks on a size-class table, usable in static_assert
+
+template <std::size_t N>
+constexpr bool strictly_ascending(const std::array<std::size_t, N> &sizes) {
+    for (std::size_t i = 1; i < N; i++) {
+        if (sizes[i] <= sizes[i - 1]) return false;
+    }
+    return true;
+}
+
+template <std::size_t N>
+constexpr bool all_multiples_of(const std::array<std::size_t, N> &sizes, std::size_t align) {
+    for (std::size_t s : sizes) {
+        if (s == 0 || s % align != 0) return false;
+    }
+    return true;
+}
+
+// Worst internal waste, as a percentage of the class, over the smallest
+// request each class serves. Gaps of one alignment unit are unavoidable and
+// not counted.
+template <std::size_t N>
+constexpr std::size_t worst_waste_percent(const std::array<std::size_t, N> &sizes, std::size_t align) {
+    std::size_t worst = 0;
+    for (std::size_t i = 1; i < N; i++) {
+        std::size_t waste = sizes[i] - sizes[i - 1] - 1;
+        if (waste < align) continue;
+        std::size_t percent = (waste * 100 + sizes[i] - 1) / sizes[i];
+        worst = percent > worst ? percent : worst;
+    }
+    return worst;
+}
+
+template <std::size_t N>
+constexpr std::size_t largest_of(const std::array<std::size_t, N> &sizes) {
+    std::size_t max = 0;
+    for (std::size_t s : sizes) max = s > max ? s : max;
+    return max;
+}
+
+// Size classes listed by hand
+template <std::size_t... Sizes>
+struct size_classes {
+    static constexpr std::size_t count = sizeof...(Sizes);
+    static constexpr std::array<std::size_t, count> sizes{Sizes...};
+
+    static constexpr std::size_t largest() { return largest_of(sizes); }
+    static constexpr bool ascending() { return strictly_ascending(sizes); }
+};
+
+// Size classes from Align up to Largest, each as far above the previous one
+// as MaxWastePercent allows
+template <std::size_t Align, std::size_t Largest, std::size_t MaxWastePercent>
+struct spaced_classes {
+    static_assert(Largest % Align == 0, "Largest must be a multiple of Align");
+    static_assert(MaxWastePercent > 0 && MaxWastePercent < 100, "MaxWastePercent must be 1-99");
+
+private:
+    // The largest class that still serves a request of c + 1 within bounds
+    static constexpr std::size_t next_class(std::size_t c) {
+        std::size_t limit = (c + 1) * 100 / (100 - MaxWastePercent);
+        std::size_t next = limit / Align * Align;
+        if (next < c + Align) next = c + Align;
+        return next > Largest ? Largest : next;
+    }
+
+    static constexpr std::size_t count_classes() {
+        std::size_t n = 1;
+        for (std::size_t c = Align; c < Largest; c = next_class(c)) n++;
+        return n;
+    }
+
+public:
+    static constexpr std::size_t count = count_classes();
+
+private:
+    static constexpr std::array<std::size_t, count> generate() {
+        std::array<std::size_t, count> table{};
+        std::size_t c = Align;
+        for (std::size_t i = 0; i < count; i++) {
+            table[i] = c;
+            c = next_class(c);
+        }
+        return table;
+    }
+
+public:
+    static constexpr std::array<std::size_t, count> sizes = generate();
+
+    static constexpr std::size_t largest() { return largest_of(sizes); }
+    static constexpr bool ascending() { return strictly_ascending(sizes); }
+
+    static_assert(strictly_ascending(sizes) && sizes[count - 1] == Largest);
+    static_assert(worst_waste_percent(sizes, Align) <= MaxWastePercent);
+};
+
+// Payload for each request size in units of Align, up to the largest class:
+// table[g] is the smallest class holding g * Align bytes, and at least
+// min_payload. Size-class lookup is then one indexed load.
+template <typename Classes, std::size_t Align, std::size_t MinPayload>
+constexpr std::array<std::size_t, Classes::largest() / Align + 1> class_table() {
+    std::array<std::size_t, Classes::largest() / Align + 1> table{};
+    std::size_t c = 0;
+    for (std::size_t g = 0; g < table.size(); g++) {
+        while (Classes::sizes[c] < g * Align) c++;
+        table[g] = Classes::sizes[c] < MinPayload ? MinPayload : Classes::sizes[c];
+    }
+    return table;
+}
+
+enum class free_status {
+    ok,
+    out_of_bounds,    // Not inside the heap at all
+    misaligned,       // Inside the heap but not the start of a payload
+    double_free,      // Start of a payload that is already free
+};
+
+struct heap_stats {
+    std::size_t held;         // Bytes of live chunks, headers included
+    std::size_t requested;    // Bytes requested by live allocations
+    std::size_t peak_held;
+    std::size_t peak_requested;
+    std::size_t allocations;  // Successful allocate() calls
+    std::size_t frees;        // Successful deallocate() calls
+    std::size_t failed;       // allocate() calls that returned nullptr
+};
+
+constexpr std::size_t round_up(std::size_t n, std::size_t to) {
+    return (n + to - 1) & ~(to - 1);
+}
+
+template <std::size_t Capacity, std::size_t Align = 8, typename Policy = first_fit,
+          typename SizeClasses = size_classes<>, typename Layout = inline_headers>
+class Heap {
+    static_assert(Align >= 8 && (Align & (Align - 1)) == 0,
+                  "Align must be a power of two of at least 8");
+    static_assert(std::is_same_v<Policy, first_fit> || std::is_same_v<Policy, best_fit>,
+                  "Policy must be mm::first_fit or mm::best_fit");
+    static_assert(std::is_same_v<Layout, inline_headers> || std::is_same_v<Layout, out_of_band>,
+                  "Layout must be mm::inline_headers or mm::out_of_band");
+
+    static constexpr bool side = std::is_same_v<Layout, out_of_band>;
+    static constexpr std::size_t granules = Capacity / Align;
+    static constexpr std::uint32_t used_bit = std::uint32_t(1) << 31;
+
+    struct chunk {
+        std::size_t size;          // Payload bytes
+        std::uint32_t allocated;
+        std::uint32_t requested;   // Bytes asked for, for the statistics
+    };
+
+    // Out-of-band headers, indexed by granule. Only a chunk's first granule
+    // has a nonzero tag.
+    struct side_tables {
+        std::array<std::uint32_t, granules> tag;        // Size in granules | used_bit
+        std::array<std::uint32_t, granules> prev;       // First granule of the chunk before
+        std::array<std::uint32_t, granules> requested;  // Bytes asked for
+    };
+    struct no_tables {};
+
+public:
+    static constexpr std::size_t capacity = Capacity;
+    static constexpr std::size_t alignment = Align;
+    static constexpr std::size_t header_size = side ? 0 : round_up(sizeof(chunk), Align);
+    static constexpr std::size_t min_payload = Align;
+
+    static_assert(Capacity % Align == 0, "Capacity must be a multiple of Align");
+    static_assert(Capacity >= header_size + min_payload, "Capacity too small for one chunk");
+    static_assert(SizeClasses::ascending(), "size classes must be strictly ascending");
+    static_assert(all_multiples_of(SizeClasses::sizes, Align), "size classes must be multiples of Align");
+    static_assert(!side || granules < used_bit, "Capacity has too many granules for out_of_band");
+
+    // Payload bytes given to a request of `size` bytes
+    static constexpr std::size_t payload_size(std::size_t size) {
+        if constexpr (SizeClasses::count > 0) {
+            constexpr auto table = class_table<SizeClasses, Align, min_payload>();
+            if (size <= SizeClasses::largest()) {
+                return table[(size + Align - 1) / Align];
+            }
+        }
+        std::size_t aligned = round_up(size, Align);
+        return aligned < min_payload ? min_payload : aligned;
+    }
+
+    void *allocate(std::size_t size) noexcept {
+        if (size == 0 || size > Capacity - header_size) {
+            stats_.failed++;
+            return nullptr;
+        }
+        init();
+
+        std::size_t need = payload_size(size);
+        if constexpr (side) {
+            std::size_t g = side_fit(need / Align);
+            if (g == granules) {
+                stats_.failed++;
+                return nullptr;
+            }
+            side_split(g, need / Align);
+            meta_.tag[g] |= used_bit;
+            meta_.requested[g] = size > UINT32_MAX ? UINT32_MAX : (std::uint32_t)size;
+            count_allocated(meta_.requested[g], need);
+            return storage_ + g * Align;
+        }
+
+        chunk *fit = nullptr;
+        for (chunk *c = first(); c != end(); c = next(c)) {
+            if (c->allocated || c->size < need) continue;
+            if constexpr (std::is_same_v<Policy, first_fit>) {
+                fit = c;
+                break;
+            } else {
+                if (fit == nullptr || c->size < fit->size) fit = c;
+                if (c->size == need) break;
+            }
+        }
+        if (fit == nullptr) {
+            stats_.failed++;
+            return nullptr;
+        }
+
+        split(fit, need);
+        fit->allocated = 1;
+        fit->requested = size > UINT32_MAX ? UINT32_MAX : (std::uint32_t)size;
+        count_allocated(fit->requested, fit->size);
+        return payload(fit);
+    }
+
+    free_status deallocate(void *ptr) noexcept {
+        if (ptr == nullptr) return free_status::ok;
+
+        unsigned char *p = static_cast<unsigned char *>(ptr);
+        if (p < storage_ || p >= storage_ + Capacity) return free_status::out_of_bounds;
+        if ((std::size_t)(p - storage_) % Align != 0) return free_status::misaligned;
+        init();
+        if constexpr (side) {
+            return side_free((std::size_t)(p - storage_) / Align);
+        }
+
+        // Walk to the chunk, remembering its predecessor for coalescing
+        chunk *prev = nullptr, *c = first();
+        while (c != end() && payload(c) < p) {
+            prev = c;
+            c = next(c);
+        }
+        if (c == end() || payload(c) != p) return free_status::misaligned;
+        if (!c->allocated) return free_status::double_free;
+
+        c->allocated = 0;
+        count_freed(c->requested, c->size);
+        c->requested = 0;
+
+        chunk *after = next(c);
+        if (after != end() && !after->allocated) {
+            c->size += header_size + after->size;
+        }
+        if (prev != nullptr && !prev->allocated) {
+            prev->size += header_size + c->size;
+        }
+        return free_status::ok;
+    }
+
+    heap_stats stats() const noexcept { return stats_; }
+
+    // Restart the high-water marks from the current usage
+    void reset_peak() noexcept {
+        stats_.peak_held = stats_.held;
+        stats_.peak_requested = stats_.requested;
+    }
+
+    // Discard every allocation
+    void reset() noexcept {
+        initialized_ = false;
+        stats_ = heap_stats{};
+    }
+
+    // Walk the heap checking sizes, flags, coalescing and the counters;
+    // returns the number of problems found
+    int check() noexcept {
+        init();
+        if constexpr (side) {
+            return side_check();
+        }
+        int problems = 0;
+        std::size_t held = 0;
+        bool prev_free = false;
+
+        for (chunk *c = first(); c != end(); c = next(c)) {
+            unsigned char *start = reinterpret_cast<unsigned char *>(c);
+            if (c->size < min_payload || c->size % Align != 0
+                || start + header_size + c->size > storage_ + Capacity) {
+                return problems + 1;  // Cannot continue the walk
+            }
+            if (c->allocated > 1) problems++;
+            if (!c->allocated && prev_free) problems++;  // Missed coalescing
+            if (c->allocated) held += header_size + c->size;
+            prev_free = !c->allocated;
+        }
+        if (held != stats_.held) problems++;
+        return problems;
+    }
+
+private:
+    alignas(Align) unsigned char storage_[Capacity];
+    std::conditional_t<side, side_tables, no_tables> meta_;
+    bool initialized_ = false;
+    heap_stats stats_ = {};
+
+    void init() noexcept {
+        if constexpr (side) {
+            if (!initialized_) {
+                meta_.tag.fill(0);
+                meta_.tag[0] = granules;
+                meta_.prev[0] = 0;
+                meta_.requested[0] = 0;
+                initialized_ = true;
+            }
+            return;
+        }
+        if (!initialized_) {
+            chunk *c = first();
+            c->size = Capacity - header_size;
+            c->allocated = 0;
+            c->requested = 0;
+            initialized_ = true;
+        }
+    }
+
+    chunk *first() noexcept { return reinterpret_cast<chunk *>(storage_); }
+    chunk *end() noexcept { return reinterpret_cast<chunk *>(storage_ + Capacity); }
+
+    static chunk *next(chunk *c) noexcept {
+        return reinterpret_cast<chunk *>(reinterpret_cast<unsigned char *>(c) + header_size + c->size);
+    }
+
+    static void *payload(chunk *c) noexcept {
+        return reinterpret_cast<unsigned char *>(c) + header_size;
+    }
+
+    // Give the tail of `c` beyond `need` back as a free chunk if it can hold
+    // one. Free chunks are always coalesced, so the next chunk is allocated.
+    static void split(chunk *c, std::size_t need) noexcept {
+        if (c->size < need + header_size + min_payload) return;
+        chunk *rest = reinterpret_cast<chunk *>(reinterpret_cast<unsigned char *>(c) + header_size + need);
+        rest->size = c->size - need - header_size;
+        rest->allocated = 0;
+        rest->requested = 0;
+        c->size = need;
+    }
+
+    void count_allocated(std::uint32_t requested, std::size_t payload) noexcept {
+        stats_.allocations++;
+        stats_.requested += requested;
+        stats_.held += header_size + payload;
+        if (stats_.held > stats_.peak_held) stats_.peak_held = stats_.held;
+        if (stats_.requested > stats_.peak_requested) stats_.peak_requested = stats_.requested;
+    }
+
+    void count_freed(std::uint32_t requested, std::size_t payload) noexcept {
+        stats_.frees++;
+        stats_.requested -= requested;
+        stats_.held -= header_size + payload;
+    }
+
+    // The out_of_band counterparts of the walks above, over granule indices
+
+    // First free chunk of at least need granules (smallest, for best fit),
+    // or granules if there is none
+    std::size_t side_fit(std::size_t need) const noexcept {
+        std::size_t fit = granules;
+        for (std::size_t g = 0; g < granules; g += meta_.tag[g] & ~used_bit) {
+            std::uint32_t tag = meta_.tag[g];
+            if ((tag & used_bit) || tag < need) continue;
+            if constexpr (std::is_same_v<Policy, first_fit>) {
+                return g;
+            } else {
+                if (fit == granules || tag < meta_.tag[fit]) fit = g;
+                if (tag == need) break;
+            }
+        }
+        return fit;
+    }
+
+    // Give the granules of chunk g beyond need back as a free chunk. The
+    // minimum payload is one granule, so any remainder is enough.
+    void side_split(std::size_t g, std::size_t need) noexcept {
+        std::size_t size = meta_.tag[g];
+        if (size == need) return;
+        std::size_t rest = g + need;
+        meta_.tag[rest] = (std::uint32_t)(size - need);
+        meta_.prev[rest] = (std::uint32_t)g;
+        meta_.requested[rest] = 0;
+        if (g + size < granules) meta_.prev[g + size] = (std::uint32_t)rest;
+        meta_.tag[g] = (std::uint32_t)need;
+    }
+
+    free_status side_free(std::size_t g) noexcept {
+        std::uint32_t tag = meta_.tag[g];
+        if (tag == 0) return free_status::misaligned;  // Not the start of a chunk
+        if (!(tag & used_bit)) return free_status::double_free;
+
+        std::size_t start = g, size = tag & ~used_bit;
+        count_freed(meta_.requested[g], size * Align);
+        meta_.requested[g] = 0;
+
+        if (g + size < granules && !(meta_.tag[g + size] & used_bit)) {
+            std::size_t after = g + size;
+            size += meta_.tag[after];
+            meta_.tag[after] = 0;
+        }
+        if (g > 0 && !(meta_.tag[meta_.prev[g]] & used_bit)) {
+            start = meta_.prev[g];
+            size += meta_.tag[start];
+            meta_.tag[g] = 0;
+        }
+        meta_.tag[start] = (std::uint32_t)size;
+        if (start + size < granules) meta_.prev[start + size] = (std::uint32_t)start;
+        return free_status::ok;
+    }
+
+    int side_check() const noexcept {
+        int problems = 0;
+        std::size_t held = 0, prev = 0;
+        bool prev_free = false;
+
+        for (std::size_t g = 0; g < granules;) {
+            std::uint32_t tag = meta_.tag[g];
+            std::size_t size = tag & ~used_bit;
+            if (size == 0 || g + size > granules) {
+                return problems + 1;  // Cannot continue the walk
+            }
+            bool free = !(tag & used_bit);
+            if (free && prev_free) problems++;  // Missed coalescing
+            if (g > 0 && meta_.prev[g] != prev) problems++;
+            if (!free) held += size * Align;
+            // Only a chunk's first granule carries a tag
+            for (std::size_t k = g + 1; k < g + size; k++) {
+                if (meta_.tag[k] != 0) problems++;
+            }
+            prev_free = free;
+            prev = g;
+            g += size;
+        }
+        if (held != stats_.held) problems++;
+        return problems;
+    }
+};
+
+}  // namespace mm
+
+#endif
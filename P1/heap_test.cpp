@@ -0,0 +1,198 @@
+/**
+ *
+ * heap_test.cpp: Tests for the compile-time configured heaps in heap.hpp
+ *
+ * Checks the parts of mm::Heap that differ between instances (placement
+ * policy, size classes, alignment, metadata layout) and the parts they
+ * share with mymalloc (coalescing, error detection), in both layouts, then
+ * drives the C wrappers in heaps.h the same way a C program would. Each test prints PASSED or FAILED; the
+ * program exits with status 1 if any test failed.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include "heap.hpp"
+#include "heaps.h"
+
+namespace {
+
+int failures = 0;
+
+void report(const char *test, bool ok) {
+    std::printf("%s test %s\n", test, ok ? "PASSED" : "FAILED");
+    if (!ok) failures++;
+}
+
+// Leave free holes of 64 and 32 bytes, in that order, and ask for 32:
+// first fit takes the first hole, best fit the exact one
+template <typename Heap>
+void *place_between_holes(Heap &heap, void **small_hole) {
+    void *a = heap.allocate(64);
+    heap.allocate(16);
+    void *c = heap.allocate(32);
+    heap.allocate(16);
+    heap.deallocate(a);
+    heap.deallocate(c);
+    *small_hole = c;
+    return heap.allocate(32);
+}
+
+template <typename Layout>
+void test_policies(const char *test) {
+    static mm::Heap<4096, 8, mm::first_fit, mm::size_classes<>, Layout> first;
+    static mm::Heap<4096, 8, mm::best_fit, mm::size_classes<>, Layout> best;
+    void *hole;
+
+    void *p = place_between_holes(first, &hole);
+    bool first_ok = p != hole && first.check() == 0;
+    p = place_between_holes(best, &hole);
+    bool best_ok = p == hole && best.check() == 0;
+    report(test, first_ok && best_ok);
+}
+
+void test_size_classes() {
+    using classed = mm::Heap<4096, 16, mm::first_fit, mm::size_classes<16, 48, 128>>;
+    static classed heap;
+
+    static_assert(classed::payload_size(1) == 16);
+    static_assert(classed::payload_size(17) == 48);
+    static_assert(classed::payload_size(100) == 128);
+    static_assert(classed::payload_size(129) == 144);
+
+    // Generated classes stay within their waste bound
+    using spaced = mm::spaced_classes<8, 512, 25>;
+    static_assert(spaced::sizes[0] == 8 && spaced::largest() == 512);
+    static_assert(mm::worst_waste_percent(spaced::sizes, 8) <= 25);
+
+    void *p = heap.allocate(20);
+    bool ok = heap.stats().held == classed::header_size + 48;
+
+    // A freed class-sized chunk is reused exactly by any size in the class
+    heap.allocate(8);
+    heap.deallocate(p);
+    void *q = heap.allocate(40);
+    ok = ok && q == p && heap.check() == 0;
+    report("Size class", ok);
+}
+
+void test_alignment() {
+    static mm::Heap<8192, 64> heap;
+    bool ok = mm::Heap<8192, 64>::header_size == 64;
+
+    for (int i = 1; i < 20; i++) {
+        void *p = heap.allocate(i * 7);
+        if (p == nullptr || reinterpret_cast<std::uintptr_t>(p) % 64 != 0) ok = false;
+    }
+    report("Alignment", ok && heap.check() == 0);
+}
+
+template <typename Layout>
+void test_coalescing(const char *test) {
+    using heap_t = mm::Heap<4096, 8, mm::first_fit, mm::size_classes<>, Layout>;
+    static heap_t heap;
+    void *ptrs[64];
+    int n = 0;
+
+    while (n < 64 && (ptrs[n] = heap.allocate(24)) != nullptr) n++;
+    // Free odd then even slots so every free merges in some direction
+    for (int i = 1; i < n; i += 2) heap.deallocate(ptrs[i]);
+    for (int i = 0; i < n; i += 2) heap.deallocate(ptrs[i]);
+
+    bool ok = heap.check() == 0 && heap.stats().held == 0;
+    void *all = heap.allocate(4096 - heap_t::header_size);
+    report(test, ok && all != nullptr);
+}
+
+template <typename Layout>
+void test_errors(const char *test) {
+    static mm::Heap<4096, 8, mm::first_fit, mm::size_classes<>, Layout> heap;
+    int local;
+
+    char *p = static_cast<char *>(heap.allocate(32));
+    bool ok = heap.deallocate(&local) == mm::free_status::out_of_bounds
+        && heap.deallocate(p + 8) == mm::free_status::misaligned
+        && heap.deallocate(p + 3) == mm::free_status::misaligned
+        && heap.deallocate(p) == mm::free_status::ok
+        && heap.deallocate(p) == mm::free_status::double_free
+        && heap.allocate(0) == nullptr
+        && heap.allocate(1 << 20) == nullptr;
+    report(test, ok && heap.check() == 0);
+}
+
+// Out-of-band headers: payloads are packed, and a payload overrun leaves
+// the metadata intact
+void test_out_of_band() {
+    using side = mm::Heap<4096, 8, mm::first_fit, mm::size_classes<>, mm::out_of_band>;
+    static side heap;
+
+    static_assert(side::header_size == 0);
+    char *a = static_cast<char *>(heap.allocate(24));
+    char *b = static_cast<char *>(heap.allocate(24));
+    char *c = static_cast<char *>(heap.allocate(4096 - 48));
+    bool ok = b == a + 24 && c == b + 24 && heap.allocate(1) == nullptr
+        && heap.stats().held == 4096;
+
+    std::memset(a, 0xff, 32);
+    ok = ok && heap.check() == 0
+        && heap.deallocate(b) == mm::free_status::ok
+        && heap.deallocate(a) == mm::free_status::ok
+        && heap.deallocate(c) == mm::free_status::ok
+        && heap.stats().held == 0 && heap.check() == 0;
+    report("Out-of-band metadata", ok && heap.allocate(4096) == a);
+}
+
+// The C wrappers, as used from C code
+void test_c_wrappers() {
+    heap_stats_t stats;
+    bool ok = true;
+
+    char *a = static_cast<char *>(heap_classes_malloc(33, MM_SITE()));
+    char *b = static_cast<char *>(heap_bestfit_malloc(33, MM_SITE()));
+    char *c = static_cast<char *>(heap_firstfit_malloc(33, MM_SITE()));
+    std::memset(a, 1, 33);
+    std::memset(b, 2, 33);
+    std::memset(c, 3, 33);
+
+    heap_classes_stats(&stats);
+    ok = ok && stats.held == 16 + 48 && stats.requested == 33 && stats.mallocs == 1;
+    heap_firstfit_stats(&stats);
+    ok = ok && stats.held == 16 + 40;
+
+    heap_classes_free(a, MM_SITE());
+    heap_bestfit_free(b, MM_SITE());
+    heap_firstfit_free(c, MM_SITE());
+    char *d = static_cast<char *>(heap_sidemeta_malloc(33, MM_SITE()));
+    std::memset(d, 4, 33);
+    heap_sidemeta_stats(&stats);
+    ok = ok && stats.held == 40;
+    heap_sidemeta_free(d, MM_SITE());
+
+    heap_classes_stats(&stats);
+    ok = ok && stats.held == 0 && stats.frees == 1;
+    ok = ok && heap_classes_check() == 0 && heap_bestfit_check() == 0 && heap_firstfit_check() == 0
+        && heap_sidemeta_check() == 0;
+    report("C wrapper", ok);
+}
+
+}  // namespace
+
+int main() {
+    test_policies<mm::inline_headers>("Placement policy");
+    test_policies<mm::out_of_band>("Out-of-band placement policy");
+    test_size_classes();
+    test_alignment();
+    test_coalescing<mm::inline_headers>("Coalescing");
+    test_coalescing<mm::out_of_band>("Out-of-band coalescing");
+    test_errors<mm::inline_headers>("Error detection");
+    test_errors<mm::out_of_band>("Out-of-band error detection");
+    test_out_of_band();
+    test_c_wrappers();
+
+    if (failures > 0) {
+        std::printf("%d heap tests FAILED\n", failures);
+        return 1;
+    }
+    std::printf("All heap tests passed\n");
+    return 0;
+}
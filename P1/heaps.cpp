@@ -0,0 +1,87 @@
+/**
+ *
+ * heaps.cpp: Heap instances from heap.hpp exported to C (see heaps.h)
+ *
+ * Built without exceptions or RTTI so the C programs can link it without
+ * the C++ runtime.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include "heap.hpp"
+#include "heaps.h"
+
+#ifndef MEMLENGTH
+#define MEMLENGTH 4096
+#endif
+
+namespace {
+
+mm::Heap<MEMLENGTH, 8, mm::first_fit> firstfit;
+mm::Heap<MEMLENGTH, 8, mm::best_fit> bestfit;
+mm::Heap<MEMLENGTH, 16, mm::first_fit,
+         mm::size_classes<16, 32, 48, 64, 96, 128, 256, 512>> classes;
+mm::Heap<MEMLENGTH, 8, mm::first_fit, mm::size_classes<>, mm::out_of_band> sidemeta;
+
+// The size-class lookup is folded at compile time
+static_assert(decltype(classes)::payload_size(1) == 16);
+static_assert(decltype(classes)::payload_size(33) == 48);
+static_assert(decltype(classes)::payload_size(300) == 512);
+static_assert(decltype(classes)::payload_size(513) == 528);
+static_assert(decltype(firstfit)::payload_size(1) == 8);
+
+template <typename Heap>
+void *checked_malloc(Heap &heap, std::size_t size, const mm_site_t *site) {
+    void *p = heap.allocate(size);
+    if (p == nullptr) {
+        std::fprintf(stderr, "malloc: Unable to allocate %zu bytes (%s:%d)\n", size, site->file, site->line);
+    }
+    return p;
+}
+
+template <typename Heap>
+void checked_free(Heap &heap, void *ptr, const mm_site_t *site) {
+    const char *problem = nullptr;
+    switch (heap.deallocate(ptr)) {
+    case mm::free_status::ok: return;
+    case mm::free_status::out_of_bounds: problem = "Inappropriate pointer, out of bounds"; break;
+    case mm::free_status::misaligned: problem = "Inappropriate pointer, misaligned"; break;
+    case mm::free_status::double_free: problem = "Double free"; break;
+    }
+    std::fprintf(stderr, "free: %s (%s:%d)\n", problem, site->file, site->line);
+    std::exit(2);
+}
+
+template <typename Heap>
+void copy_stats(const Heap &heap, heap_stats_t *out) {
+    mm::heap_stats s = heap.stats();
+    out->requested = s.requested;
+    out->held = s.held;
+    out->peak_requested = s.peak_requested;
+    out->peak_held = s.peak_held;
+    out->mallocs = s.allocations;
+    out->frees = s.frees;
+    out->failed = s.failed;
+    out->heap_size = Heap::capacity;
+}
+
+}  // namespace
+
+#define HEAP_DEFINE(name) \
+    void *heap_##name##_malloc(size_t size, mm_site_t *site) { \
+        return checked_malloc(name, size, site); \
+    } \
+    void heap_##name##_free(void *ptr, mm_site_t *site) { \
+        checked_free(name, ptr, site); \
+    } \
+    void heap_##name##_stats(heap_stats_t *stats) { copy_stats(name, stats); } \
+    void heap_##name##_reset_peak(void) { name.reset_peak(); } \
+    void heap_##name##_reset(void) { name.reset(); } \
+    int heap_##name##_check(void) { return name.check(); }
+
+extern "C" {
+HEAP_DEFINE(firstfit)
+HEAP_DEFINE(bestfit)
+HEAP_DEFINE(classes)
+HEAP_DEFINE(sidemeta)
+}
@@ -0,0 +1,62 @@
+/**
+ *
+ * heaps.h: C interface to the compile-time configured heaps in heap.hpp
+ *
+ * heaps.cpp instantiates a few differently tuned mm::Heap templates, each
+ * MEMLENGTH bytes (4096 unless overridden), and exports them to C:
+ *
+ *   firstfit  8-byte alignment, first fit: the same design as mymalloc.c
+ *   bestfit   8-byte alignment, best fit
+ *   classes   16-byte alignment, first fit, size classes 16, 32, 48, 64,
+ *             96, 128, 256 and 512
+ *   sidemeta  8-byte alignment, first fit, chunk headers kept out of band
+ *             in dense arrays beside the payloads
+ *
+ * Each heap NAME gets heap_NAME_malloc(), heap_NAME_free(), and so on, with
+ * the same conventions as mymalloc: the caller passes MM_SITE(), a failed
+ * allocation prints a message and returns NULL, and freeing a bad pointer
+ * prints a message and exits with status 2. The heaps are also allocator
+ * backends of the same names (see allocators.h).
+ */
+
+#ifndef HEAPS_H
+#define HEAPS_H
+
+#include <stddef.h>
+#include "callsite.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct heap_stats {
+    size_t requested;       // Bytes requested by live allocations
+    size_t held;            // Heap bytes occupied by live allocations
+    size_t peak_requested;  // High-water mark of requested
+    size_t peak_held;       // High-water mark of held
+    size_t mallocs;         // Successful allocations
+    size_t frees;           // Successful frees
+    size_t failed;          // Allocations that returned NULL
+    size_t heap_size;       // Total heap size
+} heap_stats_t;
+
+#define HEAP_DECLARE(name) \
+    void *heap_##name##_malloc(size_t size, mm_site_t *site); \
+    void heap_##name##_free(void *ptr, mm_site_t *site); \
+    void heap_##name##_stats(heap_stats_t *stats); \
+    void heap_##name##_reset_peak(void); \
+    void heap_##name##_reset(void); \
+    int heap_##name##_check(void);
+
+HEAP_DECLARE(firstfit)
+HEAP_DECLARE(bestfit)
+HEAP_DECLARE(classes)
+HEAP_DECLARE(sidemeta)
+
+#undef HEAP_DECLARE
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+/**
+ *
+ * lifetime_test.c: Tests for the object lifetime report (-DLIFETIMES)
+ *
+ * One site allocates and immediately frees, as memgrind's first workload
+ * does; another keeps its objects alive across many operations. The report
+ * must name the first as short-lived and not the second, and break both
+ * down by size class. The report is written to a pipe and read back. Each
+ * test prints PASSED or FAILED; the program exits with status 1 if any test
+ * failed.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "mymalloc.h"
+
+#define ROUNDS 200
+#define KEPT 40
+
+static int failures = 0;
+
+static void report(const char *test, int ok) {
+    printf("%s test %s\n", test, ok ? "PASSED" : "FAILED");
+    if (!ok) failures++;
+}
+
+int main(void) {
+    void *kept[KEPT];
+    char text[8192];
+    char line[64];
+    int fds[2];
+
+    int long_line = 0, short_line = 0;
+
+    // Both sites' lines are recorded on the line that allocates
+    for (int i = 0; i < KEPT; i++) {
+        kept[i] = malloc(48); long_line = __LINE__;
+    }
+    for (int i = 0; i < ROUNDS; i++) {
+        free(malloc(1)); short_line = __LINE__;
+    }
+    for (int i = 0; i < KEPT; i++) {
+        free(kept[i]);
+    }
+
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    mymalloc_lifetime_report(fds[1]);
+    ssize_t n = read(fds[0], text, sizeof(text) - 1);
+    text[n > 0 ? n : 0] = '\0';
+
+    snprintf(line, sizeof(line), "short-lived site lifetime_test.c:%d:", short_line);
+    report("Short-lived site", strstr(text, line) != NULL);
+    snprintf(line, sizeof(line), "short-lived site lifetime_test.c:%d:", long_line);
+    report("Long-lived site", strstr(text, line) == NULL);
+    report("Size classes", strstr(text, "<= 16 bytes") != NULL && strstr(text, "<= 64 bytes") != NULL);
+
+    if (failures > 0) {
+        printf("%d lifetime tests FAILED\n", failures);
+        printf("%s", text);
+        return 1;
+    }
+    printf("All lifetime tests passed\n");
+    return 0;
+}
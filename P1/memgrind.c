@@ -1,178 +1,556 @@
 /**
  *
  * memgrind.c: Performance testing program for mymalloc/myfree
- * 
+ *
  * This program performs stress testing on the mymalloc/myfree implementation
- * by running five different workloads 50 times each and reporting the average
- * execution time. The workloads are designed to simulate different memory 
+ * by running allocation workloads repeatedly and reporting the average
+ * execution time. The workloads are designed to simulate different memory
  * allocation patterns that might be encountered in real applications.
- * 
- * Workloads:
+ *
+ * Workloads (see workloads.c):
  * 1. Sequential malloc/free: Allocate and immediately free 1 byte, 120 times
  * 2. Batch allocation: Allocate 120 1-byte objects, then free all
  * 3. Random allocation/deallocation: Randomly choose between allocating a new
  *    1-byte object or freeing a previously allocated one, until 120 allocations
  * 4. Linked list: Create and destroy a linked list with 120 nodes
  * 5. Dynamic 2D array: Allocate and free a 2D array
- * 
- * Each workload is run 50 times, and the average execution time in microseconds
- * is reported at the end.
+ * 6-12. Production-style patterns: powerlaw, larson, cfrac, vector, intern,
+ *    tree and lru
+ *
+ * With no arguments the five original workloads are run 50 times each, as in
+ * the project requirements. Options:
+ *
+ *   -w LIST   comma-separated workload names or numbers, or "all"
+ *   -n OPS    operations per run (default: per-workload)
+ *   -s SIZE   working-set size per run (default: per-workload)
+ *   -r RUNS   number of runs to average over (default 50)
+ *   -S SEED   random seed (default: time of day)
+ *   -a LIST   comma-separated allocators to compare (see allocators.h),
+ *             e.g. "mymalloc,system,dlopen:libjemalloc.so.2"
+ *   -o FILE   also write the results as CSV to FILE, one line per allocator
+ *             and workload: allocator,workload,ops,ns_per_op,ops_per_sec
+ *   -b FILE   save every run's ns/op as a baseline in FILE (see baseline.h)
+ *   -c FILE   compare against the baseline in FILE and exit with status 3
+ *             if any workload got significantly slower
+ *   -p        also count hardware events (cycles, instructions, cache, branch
+ *             and TLB misses) with perf_event_open and report them per op
+ *   -l        list the available workloads
+ *
+ * For example, "./memgrind -w lru,tree -n 1000000 -r 5" sweeps two workloads
+ * with a million operations each. Larger working sets need a larger heap:
+ * rebuild with "make MEMLENGTH=<bytes>".
+ *
+ * After the timings, a memory table gives each workload's peak resident set
+ * size, its growth during the run, and (for mymalloc) the heap high-water
+ * mark from the allocator's counters next to the peak bytes requested.
+ *
+ * When more than one allocator is given, a comparison table follows the
+ * results with throughput relative to the first allocator, the peak growth
+ * in resident set size during a run, the peak live bytes the workload asked
+ * for (measured in a separate untimed pass) and the fragmentation implied by
+ * the two: 1 - live / RSS growth.
+ *
+ * To decide whether a change to mymalloc.c made things faster or slower,
+ * save a baseline before the change and compare after it with the same
+ * options and seed:
+ *
+ *   ./memgrind -w all -n 20000 -r 20 -S 1 -b before.txt
+ *   (edit mymalloc.c, make)
+ *   ./memgrind -w all -n 20000 -r 20 -S 1 -c before.txt
+ *
+ * Each run is one sample. A workload counts as a regression when a one-sided
+ * Mann-Whitney U test says its samples are slower at the 1% level and its
+ * median ns/op grew by more than 5%; the second condition keeps tiny but
+ * consistent shifts from failing the gate. Use at least 10 runs.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
-#include "mymalloc.h"
-#include <sys/time.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
 #include <time.h>
+#include "workloads.h"
+#include "baseline.h"
+#include "memusage.h"
+#include "perfcounters.h"
+
+#define MAX_SELECTED 64
+#define MAX_ALLOCATORS 8
 
-// Workload 1: Malloc/free 1 byte 120 times
-void test_workload1() {
-    for (int i = 0; i < 120; i++) {
-        void *ptr = malloc(1);
-        free(ptr);
+typedef struct totals {
+    double time;         // Total microseconds over all runs
+    long ops;
+    long failed;
+    long peak_rss_kb;    // Largest process peak RSS seen during a run
+    long rss_growth_kb;  // Largest RSS growth seen in a single run
+    size_t peak_live;    // Peak live bytes requested, from the accounting pass
+    allocator_usage_t heap;  // Allocator's own high-water marks, if it has any
+    uint64_t counters[PERF_NEVENTS];  // Summed hardware events (with -p)
+} totals_t;
+
+static void list_workloads(void) {
+    printf("Available workloads:\n");
+    for (int i = 0; workloads[i].name != NULL; i++) {
+        printf("  %2d %-9s %-32s (ops %ld, size %ld)\n", i + 1,
+               workloads[i].name, workloads[i].description,
+               workloads[i].default_ops, workloads[i].default_size);
     }
 }
 
-// Workload 2: Malloc 120 1-byte chunks, then free all
-void test_workload2() {
-    void *ptrs[120];
-    for (int i = 0; i < 120; i++) {
-        ptrs[i] = malloc(1);
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-w LIST] [-n OPS] [-s SIZE] [-r RUNS] [-S SEED] [-a LIST] [-o FILE]\n"
+            "       [-b FILE] [-c FILE] [-p] [-l]\n", prog);
+}
+
+// Parse a comma-separated workload list into `selected`, returning the count
+static int select_workloads(char *list, const workload_t **selected) {
+    int count = 0;
+
+    if (strcmp(list, "all") == 0) {
+        for (int i = 0; workloads[i].name != NULL && count < MAX_SELECTED; i++) {
+            selected[count++] = &workloads[i];
+        }
+        return count;
     }
-    for (int i = 0; i < 120; i++) {
-        free(ptrs[i]);
+
+    for (char *name = strtok(list, ","); name != NULL; name = strtok(NULL, ",")) {
+        const workload_t *w = find_workload(name);
+        if (w == NULL) {
+            fprintf(stderr, "memgrind: unknown workload '%s'\n", name);
+            return -1;
+        }
+        if (count < MAX_SELECTED) {
+            selected[count++] = w;
+        }
+    }
+    return count;
+}
+
+// Parse a comma-separated allocator list, returning the count
+static int select_allocators(char *list, const allocator_t **selected) {
+    int count = 0;
+
+    for (char *spec = strtok(list, ","); spec != NULL; spec = strtok(NULL, ",")) {
+        // dlopen specs may carry their own "MALLOC,FREE" pair
+        if (strncmp(spec, "dlopen:", 7) == 0 && strchr(spec + 7, ':') != NULL) {
+            char *free_sym = strtok(NULL, ",");
+            if (free_sym != NULL) free_sym[-1] = ',';
+        }
+        const allocator_t *a = find_allocator(spec);
+        if (a == NULL) return -1;
+        if (count < MAX_ALLOCATORS) {
+            selected[count++] = a;
+        }
     }
+    return count;
 }
 
-// Workload 3: Random malloc/free until 120 allocations
-void test_workload3() {
-    void *ptrs[120] = {NULL};
-    int allocated = 0;
-    int inUse = 0;
-    
-    while (allocated < 120) {
-        if (inUse == 0 || (rand() % 2 == 0 && allocated < 120)) {
-            // Allocate
-            ptrs[inUse++] = malloc(1);
-            allocated++;
+static void print_results(const workload_t **selected, int nselected,
+                          const totals_t *totals, int runs) {
+    double grand_total = 0;
+
+    for (int w = 0; w < nselected; w++) {
+        int number = (int)(selected[w] - workloads) + 1;
+        double ns_per_op = totals[w].ops ? totals[w].time * 1000.0 / totals[w].ops : 0.0;
+
+        printf("Workload %d (%s): Average time %f microseconds (%ld ops, %.1f ns/op",
+               number, selected[w]->description, totals[w].time / runs,
+               totals[w].ops / runs, ns_per_op);
+        if (totals[w].failed > 0) {
+            printf(", %ld failed allocations", totals[w].failed / runs);
+        }
+        printf(")\n");
+        grand_total += totals[w].time;
+    }
+
+    double total_average = grand_total / runs / nselected;
+    printf("\nOverall average time across all workloads: %f microseconds\n", total_average);
+}
+
+// Per-workload footprint: process RSS next to the heap's own high-water
+// marks, so memory regressions show up alongside the timings
+static void print_memory(const workload_t **selected, int nselected,
+                         const allocator_t *alloc, const totals_t *totals) {
+    printf("\nMemory (worst run):\n");
+    printf("%-9s %11s %11s %13s %13s %9s\n", "Workload", "peak RSS", "RSS growth",
+           "heap peak", "requested", "overhead");
+
+    for (int w = 0; w < nselected; w++) {
+        const totals_t *t = &totals[w];
+        printf("%-9s %8ld KB %8ld KB", selected[w]->name, t->peak_rss_kb, t->rss_growth_kb);
+        if (alloc->usage != NULL) {
+            double overhead = t->heap.peak_requested
+                ? 100.0 * ((double)t->heap.peak_held / t->heap.peak_requested - 1.0) : 0.0;
+            printf(" %8zu bytes %7zu bytes %8.0f%%\n", t->heap.peak_held,
+                   t->heap.peak_requested, overhead);
         } else {
-            // Free
-            int index = rand() % inUse;
-            free(ptrs[index]);
-            ptrs[index] = ptrs[--inUse];
+            printf(" %13s %13s %9s\n", "-", "-", "-");
         }
     }
-    
-    // Free remaining blocks
-    while (inUse > 0) {
-        free(ptrs[--inUse]);
+    printf("Heap peak counts headers and padding; overhead is heap peak over the\n"
+           "peak bytes requested.\n");
+}
+
+// Hardware events divided by the number of allocator operations
+static void print_counters(const workload_t **selected, int nselected,
+                           const totals_t *totals) {
+    printf("\nHardware counters (per operation):\n");
+    printf("%-9s", "Workload");
+    for (int e = 0; e < PERF_NEVENTS; e++) {
+        printf(" %10s", perf_event_name(e));
+    }
+    printf(" %6s\n", "IPC");
+
+    for (int w = 0; w < nselected; w++) {
+        const totals_t *t = &totals[w];
+        const uint64_t *c = t->counters;
+
+        printf("%-9s", selected[w]->name);
+        for (int e = 0; e < PERF_NEVENTS; e++) {
+            if (c[e] == PERF_UNAVAILABLE || t->ops == 0) {
+                printf(" %10s", "-");
+            } else {
+                printf(" %10.2f", (double)c[e] / t->ops);
+            }
+        }
+        if (c[PERF_CYCLES] != PERF_UNAVAILABLE && c[PERF_INSTRUCTIONS] != PERF_UNAVAILABLE
+            && c[PERF_CYCLES] > 0) {
+            printf(" %6.2f\n", (double)c[PERF_INSTRUCTIONS] / c[PERF_CYCLES]);
+        } else {
+            printf(" %6s\n", "-");
+        }
     }
 }
 
-// Workload 4: Linked list - Create/destroy a linked list
-typedef struct node {
-    int data;
-    struct node *next;
-} Node;
-
-void test_workload4() {
-    Node *head = NULL;
-    
-    // Create a linked list with 120 nodes
-    for (int i = 0; i < 120; i++) {
-        // Create a new node
-        Node *newNode = (Node*)malloc(sizeof(Node));
-        newNode->data = i;
-        newNode->next = head;
-        head = newNode;
-    }
-    
-    // Traverse and free the linked list
-    while (head != NULL) {
-        Node *temp = head;
-        head = head->next;
-        free(temp);
+static int write_csv(const char *path, const workload_t **selected, int nselected,
+                     const allocator_t **allocators, int nallocators,
+                     totals_t totals[][MAX_SELECTED]) {
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        perror(path);
+        return -1;
     }
+
+    fprintf(out, "allocator,workload,ops,ns_per_op,ops_per_sec\n");
+    for (int a = 0; a < nallocators; a++) {
+        for (int w = 0; w < nselected; w++) {
+            const totals_t *t = &totals[a][w];
+            double ns_per_op = t->ops ? t->time * 1000.0 / t->ops : 0.0;
+            fprintf(out, "%s,%s,%ld,%.2f,%.0f\n", allocators[a]->name, selected[w]->name,
+                    t->ops, ns_per_op, ns_per_op > 0 ? 1e9 / ns_per_op : 0.0);
+        }
+    }
+    return fclose(out);
 }
 
-// Workload 5: Dynamic 2D array - Allocate and free a 2D array
-void test_workload5() {
-    int rows = 15;
-    int cols = 8;
-    
-    // Allocate array of row pointers
-    int **matrix = (int**)malloc(rows * sizeof(int*));
-    
-    // Allocate each row
-    for (int i = 0; i < rows; i++) {
-        matrix[i] = (int*)malloc(cols * sizeof(int));
-        
-        // Initialize with some values
-        for (int j = 0; j < cols; j++) {
-            matrix[i][j] = i * cols + j;
-        }
-    }
-    
-    // Free the matrix
-    for (int i = 0; i < rows; i++) {
-        free(matrix[i]);
-    }
-    free(matrix);
+static void print_comparison(const workload_t **selected, int nselected,
+                             const allocator_t **allocators, int nallocators,
+                             totals_t totals[][MAX_SELECTED]) {
+    printf("\nComparison (throughput relative to %s):\n", allocators[0]->name);
+    printf("%-9s %-20s %12s %9s %12s %12s %6s\n", "Workload", "Allocator",
+           "ops/sec", "relative", "RSS growth", "peak live", "frag");
+
+    for (int w = 0; w < nselected; w++) {
+        double base = totals[0][w].time > 0 ? totals[0][w].ops / totals[0][w].time : 0.0;
+
+        for (int a = 0; a < nallocators; a++) {
+            const totals_t *t = &totals[a][w];
+            double rate = t->time > 0 ? t->ops / t->time : 0.0;
+            double live_kb = t->peak_live / 1024.0;
+            char frag[16] = "-";
+
+            if (t->rss_growth_kb > 0 && t->rss_growth_kb >= live_kb) {
+                snprintf(frag, sizeof(frag), "%.0f%%", 100.0 * (1.0 - live_kb / t->rss_growth_kb));
+            }
+            printf("%-9s %-20s %12.0f %8.2fx %9ld KB %9.1f KB %6s\n",
+                   a == 0 ? selected[w]->name : "", allocators[a]->name,
+                   rate * 1e6, base > 0 ? rate / base : 0.0,
+                   t->rss_growth_kb, live_kb, frag);
+        }
+    }
+    printf("RSS growth is page-granular; '-' means the pages were already resident.\n");
 }
 
-int main() {
-    struct timeval start, end;
-    long total_times[5] = {0}; // Array to track time for each workload
-    
-    // Initialize random seed
-    srand(time(NULL));
-    
-    printf("Running memgrind performance tests...\n");
-    
-    for (int i = 0; i < 50; i++) {
-        printf("Run %d/50\n", i+1);
-        
-        // Workload 1
-        gettimeofday(&start, NULL);
-        test_workload1();
-        gettimeofday(&end, NULL);
-        total_times[0] += (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
-        
-        // Workload 2
-        gettimeofday(&start, NULL);
-        test_workload2();
-        gettimeofday(&end, NULL);
-        total_times[1] += (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
-        
-        // Workload 3
-        gettimeofday(&start, NULL);
-        test_workload3();
-        gettimeofday(&end, NULL);
-        total_times[2] += (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
-        
-        // Workload 4
-        gettimeofday(&start, NULL);
-        test_workload4();
-        gettimeofday(&end, NULL);
-        total_times[3] += (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
-        
-        // Workload 5
-        gettimeofday(&start, NULL);
-        test_workload5();
-        gettimeofday(&end, NULL);
-        total_times[4] += (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
-    }
-    
-    printf("\nResults:\n");
-    printf("Workload 1 (Malloc/free in sequence): Average time %f microseconds\n", total_times[0] / 50.0);
-    printf("Workload 2 (Malloc all, then free all): Average time %f microseconds\n", total_times[1] / 50.0);
-    printf("Workload 3 (Random malloc/free): Average time %f microseconds\n", total_times[2] / 50.0);
-    printf("Workload 4 (Linked list): Average time %f microseconds\n", total_times[3] / 50.0);
-    printf("Workload 5 (Dynamic 2D array): Average time %f microseconds\n", total_times[4] / 50.0);
-    
-    double total_average = (total_times[0] + total_times[1] + total_times[2] + 
-                            total_times[3] + total_times[4]) / 50.0 / 5.0;
-    printf("\nOverall average time across all workloads: %f microseconds\n", total_average);
-    
+// Per-run samples, indexed [allocator][workload][run], in ns per operation
+static double *samples;
+static long *sample_ops;  // Operations per run, [allocator][workload]
+
+#define SAMPLES(a, w) (&samples[((a) * MAX_SELECTED + (w)) * runs])
+
+static int save_baseline(const char *path, const workload_t **selected, int nselected,
+                         const allocator_t **allocators, int nallocators, int runs) {
+    baseline_entry_t entries[MAX_ALLOCATORS * MAX_SELECTED];
+    int n = 0;
+
+    for (int a = 0; a < nallocators; a++) {
+        for (int w = 0; w < nselected; w++) {
+            baseline_entry_t *e = &entries[n++];
+            snprintf(e->allocator, sizeof(e->allocator), "%s", allocators[a]->name);
+            snprintf(e->workload, sizeof(e->workload), "%s", selected[w]->name);
+            e->ops = sample_ops[a * MAX_SELECTED + w];
+            e->nsamples = runs;
+            e->samples = SAMPLES(a, w);
+        }
+    }
+    if (baseline_write(path, entries, n) != 0) return -1;
+    printf("\nBaseline of %d runs written to %s\n", runs, path);
+    return 0;
+}
+
+// Compare every workload against the baseline, returning the number of
+// significant slowdowns or -1 if the baseline could not be read
+static int compare_baseline(const char *path, const workload_t **selected, int nselected,
+                            const allocator_t **allocators, int nallocators, int runs) {
+    int nentries;
+    baseline_entry_t *entries = baseline_read(path, &nentries);
+    if (entries == NULL) return -1;
+
+    int regressions = 0;
+    printf("\nComparison with baseline %s (Mann-Whitney U, one-sided):\n", path);
+    printf("%-9s %-20s %10s %10s %8s %9s  %s\n", "Workload", "Allocator",
+           "base ns/op", "now ns/op", "change", "p", "verdict");
+
+    for (int a = 0; a < nallocators; a++) {
+        for (int w = 0; w < nselected; w++) {
+            const baseline_entry_t *e = baseline_find(entries, nentries,
+                                                      allocators[a]->name, selected[w]->name);
+            const double *now = SAMPLES(a, w);
+            printf("%-9s %-20s ", selected[w]->name, allocators[a]->name);
+
+            if (e == NULL) {
+                printf("%10s\n", "not in baseline");
+                continue;
+            }
+            if (e->ops != sample_ops[a * MAX_SELECTED + w]) {
+                printf("%10s (%ld ops per run, baseline has %ld)\n", "skipped",
+                       sample_ops[a * MAX_SELECTED + w], e->ops);
+                continue;
+            }
+
+            double before = sample_median(e->samples, e->nsamples);
+            double after = sample_median(now, runs);
+            double change = before > 0 ? after / before - 1.0 : 0.0;
+            double p_slower = mann_whitney_p(e->samples, e->nsamples, now, runs);
+            double p_faster = mann_whitney_p(now, runs, e->samples, e->nsamples);
+            const char *verdict = "same";
+
+            if (p_slower < BASELINE_ALPHA && change > BASELINE_MIN_SLOWDOWN) {
+                verdict = "SLOWER";
+                regressions++;
+            } else if (p_slower < BASELINE_ALPHA) {
+                verdict = "slower (within tolerance)";
+            } else if (p_faster < BASELINE_ALPHA) {
+                verdict = "faster";
+            }
+            printf("%10.2f %10.2f %+7.1f%% %9.2g  %s\n", before, after, change * 100,
+                   p_slower < p_faster ? p_slower : p_faster, verdict);
+        }
+    }
+    if (runs < 5) {
+        printf("Only %d runs: too few samples for the test to find anything; use -r 10 or more.\n", runs);
+    }
+
+    baseline_free(entries, nentries);
+    return regressions;
+}
+
+int main(int argc, char *argv[]) {
+    const workload_t *selected[MAX_SELECTED];
+    const allocator_t *allocators[MAX_ALLOCATORS];
+    int nselected = 0;
+    int nallocators = 0;
+    workload_params_t params = {0, 0, 0};
+    int runs = 50;
+    int use_counters = 0;
+    const char *csv_path = NULL;
+    const char *save_path = NULL;
+    const char *compare_path = NULL;
+    int opt;
+
+    params.seed = time(NULL);
+
+    while ((opt = getopt(argc, argv, "w:n:s:r:S:a:o:b:c:pl")) != -1) {
+        switch (opt) {
+        case 'w':
+            nselected = select_workloads(optarg, selected);
+            if (nselected < 0) return 1;
+            break;
+        case 'n':
+            params.ops = atol(optarg);
+            break;
+        case 's':
+            params.size = atol(optarg);
+            break;
+        case 'r':
+            runs = atoi(optarg);
+            break;
+        case 'S':
+            params.seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'a':
+            nallocators = select_allocators(optarg, allocators);
+            if (nallocators < 0) return 1;
+            break;
+        case 'o':
+            csv_path = optarg;
+            break;
+        case 'b':
+            save_path = optarg;
+            break;
+        case 'c':
+            compare_path = optarg;
+            break;
+        case 'p':
+            use_counters = 1;
+            break;
+        case 'l':
+            list_workloads();
+            return 0;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (runs <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Default to the five original workloads
+    if (nselected == 0) {
+        for (int i = 0; i < 5; i++) {
+            selected[nselected++] = &workloads[i];
+        }
+    }
+    if (nallocators == 0) {
+        allocators[nallocators++] = find_allocator("mymalloc");
+    }
+
+    if (use_counters) {
+        int available = perf_open();
+        if (available == 0) {
+            fprintf(stderr, "memgrind: hardware counters unavailable "
+                    "(check /proc/sys/kernel/perf_event_paranoid); continuing without them\n");
+            use_counters = 0;
+        } else if (available < PERF_NEVENTS) {
+            fprintf(stderr, "memgrind: only %d of %d hardware counters available\n",
+                    available, PERF_NEVENTS);
+        }
+    }
+
+    struct timespec start, end;
+    static totals_t totals[MAX_ALLOCATORS][MAX_SELECTED]; // Time etc. for each workload
+    unsigned long first_seed = params.seed;
+
+    samples = calloc((size_t)MAX_ALLOCATORS * MAX_SELECTED * runs, sizeof(double));
+    sample_ops = calloc(MAX_ALLOCATORS * MAX_SELECTED, sizeof(long));
+    if (samples == NULL || sample_ops == NULL) {
+        fprintf(stderr, "memgrind: out of memory for %d runs\n", runs);
+        return 1;
+    }
+
+    for (int a = 0; a < nallocators; a++) {
+        const allocator_t *alloc = allocators[a];
+        params.seed = first_seed;
+
+        if (nallocators > 1) {
+            printf("\n===== Allocator: %s =====\n", alloc->name);
+        }
+        printf("Running memgrind performance tests...\n");
+
+        for (int i = 0; i < runs; i++) {
+            printf("Run %d/%d\n", i+1, runs);
+
+            for (int w = 0; w < nselected; w++) {
+                totals_t *t = &totals[a][w];
+                workload_result_t result;
+
+                reset_peak_rss();
+                long rss_before = current_rss_kb();
+                if (alloc->reset_peak != NULL) alloc->reset_peak();
+
+                uint64_t counts[PERF_NEVENTS];
+                if (use_counters) perf_start();
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                run_workload(selected[w], alloc, &params, &result);
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                if (use_counters) {
+                    perf_stop(counts);
+                    for (int e = 0; e < PERF_NEVENTS; e++) {
+                        if (counts[e] == PERF_UNAVAILABLE) {
+                            t->counters[e] = PERF_UNAVAILABLE;
+                        } else if (t->counters[e] != PERF_UNAVAILABLE) {
+                            t->counters[e] += counts[e];
+                        }
+                    }
+                }
+                double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+                t->time += elapsed_ns / 1000.0;
+                t->ops += result.ops;
+                SAMPLES(a, w)[i] = result.ops ? elapsed_ns / result.ops : elapsed_ns;
+                sample_ops[a * MAX_SELECTED + w] = result.ops;
+                t->failed += result.failed;
+
+                long peak = peak_rss_kb();
+                if (peak > t->peak_rss_kb) t->peak_rss_kb = peak;
+                if (peak - rss_before > t->rss_growth_kb) t->rss_growth_kb = peak - rss_before;
+                if (alloc->usage != NULL) {
+                    allocator_usage_t usage;
+                    alloc->usage(&usage);
+                    if (usage.peak_held > t->heap.peak_held) t->heap.peak_held = usage.peak_held;
+                    if (usage.peak_requested > t->heap.peak_requested) {
+                        t->heap.peak_requested = usage.peak_requested;
+                    }
+                }
+            }
+            params.seed++;
+        }
+
+        // Untimed pass with the first run's seed to measure live bytes
+        if (nallocators > 1) {
+            params.seed = first_seed;
+            for (int w = 0; w < nselected; w++) {
+                workload_result_t result;
+                run_workload(selected[w], accounting_allocator(alloc), &params, &result);
+                totals[a][w].peak_live = accounting_peak_bytes();
+            }
+        }
+
+        printf("\nResults:\n");
+        print_results(selected, nselected, totals[a], runs);
+        print_memory(selected, nselected, alloc, totals[a]);
+        if (use_counters) {
+            print_counters(selected, nselected, totals[a]);
+        }
+    }
+
+    if (nallocators > 1) {
+        print_comparison(selected, nselected, allocators, nallocators, totals);
+    }
+    if (use_counters) {
+        perf_close();
+    }
+    if (csv_path != NULL &&
+        write_csv(csv_path, selected, nselected, allocators, nallocators, totals) != 0) {
+        return 1;
+    }
+    if (save_path != NULL &&
+        save_baseline(save_path, selected, nselected, allocators, nallocators, runs) != 0) {
+        return 1;
+    }
+    if (compare_path != NULL) {
+        int regressions = compare_baseline(compare_path, selected, nselected,
+                                           allocators, nallocators, runs);
+        if (regressions < 0) return 1;
+        if (regressions > 0) {
+            printf("\n%d workload%s significantly slower than the baseline\n",
+                   regressions, regressions == 1 ? "" : "s");
+            return 3;
+        }
+        printf("\nNo significant slowdowns against the baseline\n");
+    }
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+/**
+ *
+ * memusage.c: Process memory usage for the benchmarks
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include "memusage.h"
+
+// Read a "Key:   1234 kB" line from /proc/self/status, or -1 if missing
+static long read_status_kb(const char *key) {
+    FILE *status = fopen("/proc/self/status", "r");
+    char line[256];
+    size_t key_len = strlen(key);
+    long value = -1;
+
+    if (status == NULL) return -1;
+    while (fgets(line, sizeof(line), status) != NULL) {
+        if (strncmp(line, key, key_len) == 0 && line[key_len] == ':') {
+            sscanf(line + key_len + 1, "%ld", &value);
+            break;
+        }
+    }
+    fclose(status);
+    return value;
+}
+
+long current_rss_kb(void) {
+    long rss = read_status_kb("VmRSS");
+    return rss < 0 ? 0 : rss;
+}
+
+long peak_rss_kb(void) {
+    long peak = read_status_kb("VmHWM");
+    if (peak < 0) {
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        peak = usage.ru_maxrss;
+    }
+    return peak;
+}
+
+int reset_peak_rss(void) {
+    // Writing 5 to clear_refs resets VmHWM (Linux 4.0 and later)
+    FILE *clear_refs = fopen("/proc/self/clear_refs", "w");
+    if (clear_refs == NULL) return -1;
+    int ok = fputs("5", clear_refs) >= 0;
+    return (fclose(clear_refs) == 0 && ok) ? 0 : -1;
+}
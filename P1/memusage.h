@@ -0,0 +1,23 @@
+/**
+ *
+ * memusage.h: Process memory usage for the benchmarks
+ *
+ * Resident set sizes come from /proc/self/status (VmRSS and VmHWM). Where
+ * /proc is unavailable the peak falls back to getrusage() and the current
+ * size reads as 0.
+ */
+
+#ifndef MEMUSAGE_H
+#define MEMUSAGE_H
+
+// Current resident set size in KB
+long current_rss_kb(void);
+
+// Peak resident set size in KB since start or the last reset_peak_rss()
+long peak_rss_kb(void);
+
+// Reset the kernel's peak RSS counter to the current RSS so the next phase
+// can be measured on its own. Returns 0 on success, -1 if unsupported.
+int reset_peak_rss(void);
+
+#endif
@@ -0,0 +1,304 @@
+/**
+ *
+ * microbench.c: Per-operation microbenchmarks for mymalloc/myfree
+ *
+ * memgrind times whole workloads, which mixes the cost of every operation
+ * together. This program times one primitive at a time against a heap laid
+ * out so that exactly N live chunks come before the chunk the operation
+ * touches. Since mymalloc() walks the heap from the start and myfree() scans
+ * from the start to find the previous chunk, the cost of both grows with N;
+ * the table makes that slope visible.
+ *
+ * Benchmarks (all with objects of the same size, 16 bytes by default):
+ *
+ *   malloc-split  malloc with N live chunks before a large free chunk, which
+ *                 gets split (N = 0 is allocation from an empty heap)
+ *   malloc-exact  malloc with N live chunks before a free chunk of exactly
+ *                 the right size, so nothing is split; the difference from
+ *                 malloc-split is the cost of splitting
+ *   free-none     free a chunk at position N whose neighbours are both live
+ *   free-fwd      free a chunk at position N followed by free space, so it
+ *                 coalesces forward
+ *   free-back     free a chunk at position N + 1 that follows a free chunk,
+ *                 so it coalesces backward
+ *
+ * Each operation is timed on its own with clock_gettime() and the heap is put
+ * back into the same layout between repetitions (untimed). The median over
+ * all repetitions is reported after subtracting the timer's own overhead.
+ * A least-squares fit of ns/op = a + b * N follows the table: b is the cost
+ * per chunk walked.
+ *
+ * Usage: ./microbench [-b LIST] [-r REPS] [-p POINTS] [-s SIZE]
+ *
+ *   -b LIST    comma-separated benchmarks to run (default: all)
+ *   -r REPS    repetitions per point (default 2000)
+ *   -p POINTS  number of values of N, spread from 0 to the most the heap
+ *              holds (default 16)
+ *   -s SIZE    object size in bytes (default 16)
+ *
+ * Build with "make MEMLENGTH=<bytes>" to sweep longer heaps. With a heap
+ * much larger than the L2 cache the walk becomes a chain of cache misses,
+ * which is what the prefetching in mymalloc.c (PREFETCH_AHEAD) targets;
+ * e.g. 123,000 chunks of 256-byte objects (laying out the heap is itself
+ * quadratic, so this takes a few minutes):
+ *
+ *   make clean && make MEMLENGTH=33554432 microbench
+ *   ./microbench -b malloc-split -s 256 -p 2 -r 50
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "mymalloc.h"
+
+#define CHUNK_HEADER 16
+#define MAX_LIVE (1 << 20)
+#define MAX_POINTS 256
+#define MAX_REPS 100000
+
+typedef enum {
+    MALLOC_SPLIT,
+    MALLOC_EXACT,
+    FREE_NONE,
+    FREE_FORWARD,
+    FREE_BACKWARD,
+    NBENCHES
+} bench_t;
+
+static const char *bench_names[NBENCHES] = {
+    [MALLOC_SPLIT]  = "malloc-split",
+    [MALLOC_EXACT]  = "malloc-exact",
+    [FREE_NONE]     = "free-none",
+    [FREE_FORWARD]  = "free-fwd",
+    [FREE_BACKWARD] = "free-back",
+};
+
+static void *live[MAX_LIVE];
+static size_t object_size = 16;
+static void *target;
+static long timings[MAX_REPS];  // Static: malloc() here is mymalloc()
+
+static long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+static int compare_long(const void *x, const void *y) {
+    long a = *(const long *)x, b = *(const long *)y;
+    return (a > b) - (a < b);
+}
+
+static long median(long *values, int n) {
+    qsort(values, n, sizeof(long), compare_long);
+    return values[n / 2];
+}
+
+static void *must_malloc(void) {
+    void *p = malloc(object_size);
+    if (p == NULL) {
+        fprintf(stderr, "microbench: heap too small for the requested layout\n");
+        exit(1);
+    }
+    return p;
+}
+
+// Lay out the heap for `bench`: n live chunks, then the chunks the
+// benchmark operates on, then free space
+static void build(bench_t bench, int n) {
+    mymalloc_reset();
+    for (int i = 0; i < n; i++) {
+        live[i] = must_malloc();
+    }
+
+    void *hole;
+    switch (bench) {
+    case MALLOC_SPLIT:
+        break;
+    case MALLOC_EXACT:
+        hole = must_malloc();
+        must_malloc();          // Guard keeps the hole from merging forward
+        free(hole);
+        break;
+    case FREE_NONE:
+        target = must_malloc();
+        must_malloc();
+        break;
+    case FREE_FORWARD:
+        target = must_malloc();
+        break;
+    case FREE_BACKWARD:
+        hole = must_malloc();
+        target = must_malloc();
+        must_malloc();
+        free(hole);
+        break;
+    default:
+        break;
+    }
+}
+
+// Time one operation, then restore the layout built above
+static long run_once(bench_t bench) {
+    long start, end;
+    void *p;
+
+    switch (bench) {
+    case MALLOC_SPLIT:
+    case MALLOC_EXACT:
+        start = now_ns();
+        p = malloc(object_size);
+        end = now_ns();
+        free(p);
+        break;
+    case FREE_NONE:
+    case FREE_FORWARD:
+        start = now_ns();
+        free(target);
+        end = now_ns();
+        target = malloc(object_size);
+        break;
+    case FREE_BACKWARD:
+        start = now_ns();
+        free(target);
+        end = now_ns();
+        // The merged chunk splits back into the hole and the target
+        p = malloc(object_size);
+        target = malloc(object_size);
+        free(p);
+        break;
+    default:
+        start = end = 0;
+        break;
+    }
+    return end - start;
+}
+
+static long timer_overhead(int reps) {
+    for (int i = 0; i < reps; i++) {
+        long start = now_ns();
+        timings[i] = now_ns() - start;
+    }
+    return median(timings, reps);
+}
+
+static double measure(bench_t bench, int n, int reps, long overhead) {
+    build(bench, n);
+    for (int i = 0; i < reps; i++) {
+        timings[i] = run_once(bench);
+    }
+    if (mymalloc_check() != 0) {
+        fprintf(stderr, "microbench: heap corrupted after %s at N = %d\n", bench_names[bench], n);
+        exit(1);
+    }
+    long ns = median(timings, reps) - overhead;
+    return ns > 0 ? ns : 0;
+}
+
+int main(int argc, char *argv[]) {
+    int enabled[NBENCHES];
+    int reps = 2000;
+    int points = 16;
+    int opt;
+
+    for (int b = 0; b < NBENCHES; b++) enabled[b] = 1;
+
+    while ((opt = getopt(argc, argv, "b:r:p:s:")) != -1) {
+        switch (opt) {
+        case 'b':
+            memset(enabled, 0, sizeof(enabled));
+            for (char *name = strtok(optarg, ","); name != NULL; name = strtok(NULL, ",")) {
+                int b;
+                for (b = 0; b < NBENCHES && strcmp(name, bench_names[b]) != 0; b++) {}
+                if (b == NBENCHES) {
+                    fprintf(stderr, "microbench: unknown benchmark '%s'\n", name);
+                    return 1;
+                }
+                enabled[b] = 1;
+            }
+            break;
+        case 'r':
+            reps = atoi(optarg);
+            break;
+        case 'p':
+            points = atoi(optarg);
+            break;
+        case 's':
+            object_size = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-b LIST] [-r REPS] [-p POINTS] [-s SIZE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps <= 0 || reps > MAX_REPS || points <= 0 || object_size == 0) {
+        fprintf(stderr, "Usage: %s [-b LIST] [-r REPS] [-p POINTS] [-s SIZE]\n", argv[0]);
+        return 1;
+    }
+    if (points > MAX_POINTS) points = MAX_POINTS;
+
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+
+    // Leave room for the three chunks free-back needs past the first N,
+    // plus a free remainder big enough to split
+    size_t chunk_bytes = ((object_size + 7) & ~(size_t)7) + CHUNK_HEADER;
+    long max_n = (long)(stats.heap_size / chunk_bytes) - 4;
+    if (max_n > MAX_LIVE) max_n = MAX_LIVE;
+    if (max_n < 0) {
+        fprintf(stderr, "microbench: heap too small\n");
+        return 1;
+    }
+    if (points > max_n + 1) points = max_n + 1;
+
+    long overhead = timer_overhead(reps);
+
+    printf("Microbenchmarks: %zu-byte objects, %zu-byte heap, %d reps per point\n",
+           object_size, stats.heap_size, reps);
+    printf("Median ns/op with %ld ns of timer overhead subtracted; N = live chunks before the operation\n\n",
+           overhead);
+
+    printf("%6s", "N");
+    for (int b = 0; b < NBENCHES; b++) {
+        if (enabled[b]) printf(" %13s", bench_names[b]);
+    }
+    printf("\n");
+
+    static double results[NBENCHES][MAX_POINTS];
+    int ns[MAX_POINTS];
+
+    for (int p = 0; p < points; p++) {
+        ns[p] = points > 1 ? (int)(max_n * p / (points - 1)) : 0;
+        printf("%6d", ns[p]);
+        for (int b = 0; b < NBENCHES; b++) {
+            if (!enabled[b]) continue;
+            results[b][p] = measure(b, ns[p], reps, overhead);
+            printf(" %13.0f", results[b][p]);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    // Least-squares fit of ns/op against N
+    if (points > 1) {
+        printf("\nFit ns/op = a + b * N:\n");
+        for (int b = 0; b < NBENCHES; b++) {
+            if (!enabled[b]) continue;
+            double sx = 0, sy = 0, sxx = 0, sxy = 0;
+            for (int p = 0; p < points; p++) {
+                sx += ns[p];
+                sy += results[b][p];
+                sxx += (double)ns[p] * ns[p];
+                sxy += ns[p] * results[b][p];
+            }
+            double slope = (points * sxy - sx * sy) / (points * sxx - sx * sx);
+            double intercept = (sy - slope * sx) / points;
+            printf("  %-13s a = %7.1f ns, b = %6.2f ns per chunk\n", bench_names[b], intercept, slope);
+        }
+    }
+
+    mymalloc_reset();
+    return 0;
+}
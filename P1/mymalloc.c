@@ -21,7 +21,9 @@
  * 
  * When an error is detected, the implementation prints a descriptive error message
  * that includes the source file and line number where the error occurred, then
- * terminates the program with exit code 2.
+ * terminates the program with exit code 2. Call sites are passed as a single
+ * pointer to a static descriptor (see callsite.h); each chunk records the id
+ * of the site that allocated it, so the leak report can name the sites.
  * 
  * Heap initialization and leak detection are handled automatically, with no need
  * for explicit initialization by client code.
@@ -29,7 +31,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <limits.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
 #include "mymalloc.h"
 #include <stdarg.h>
 
@@ -49,13 +57,127 @@
 #define DEBUG 0  
 #endif 
 
+// Distinct call sites the leak report can tell apart; later ones are
+// reported together as unknown
+#ifndef MAX_SITES
+#define MAX_SITES 1024
+#endif
+_Static_assert(MAX_SITES <= MM_SITE_TRANSIENT, "site ids must fit in the chunk header");
+
+// Threads running at once that get their own block of operation counts;
+// any further threads share the last one
+#ifndef MAX_STAT_THREADS
+#define MAX_STAT_THREADS 64
+#endif
+
+#ifndef CACHE_LINE
+#define CACHE_LINE 64
+#endif
+
+// With -DLIFETIMES, every object's lifetime is measured in allocator
+// operations (mymalloc() and myfree() calls) between its allocation and its
+// free, and aggregated by call site and size class. Objects that die within
+// LIFETIME_SHORT operations count as short-lived.
+#ifndef LIFETIME_SHORT
+#define LIFETIME_SHORT 16
+#endif
+
+// A site is reported as a candidate for arena or stack allocation once it
+// has freed LIFETIME_MIN_OBJECTS objects, LIFETIME_CANDIDATE percent of them
+// short-lived
+#ifndef LIFETIME_MIN_OBJECTS
+#define LIFETIME_MIN_OBJECTS 32
+#endif
+
+#ifndef LIFETIME_CANDIDATE
+#define LIFETIME_CANDIDATE 90
+#endif
+
+#define LIFETIME_CLASSES 32  // Power-of-two size classes from 16 bytes up
+
+// With -DBUMP, requests of up to BUMP_MAX bytes are served from a
+// per-thread bump region of BUMP_REGION bytes carved out of the heap
+#ifndef BUMP_MAX
+#define BUMP_MAX 64
+#endif
+
+#ifndef BUMP_REGION
+#define BUMP_REGION (MEMLENGTH / 8 < 65536 ? MEMLENGTH / 8 : 65536)
+#endif
+
+// A thread whose region could not be claimed serves this many small
+// requests from the normal path before it tries again
+#ifndef BUMP_CLAIM_RETRY
+#define BUMP_CLAIM_RETRY 256
+#endif
+
+// How far ahead of the current chunk, in bytes, the heap walks prefetch;
+// 0 turns prefetching off
+#ifndef PREFETCH_AHEAD
+#define PREFETCH_AHEAD 512
+#endif
+
+// With -DPARALLEL_WALK, the leak check and telemetry snapshots of a heap of
+// at least WALK_PARALLEL_MIN bytes are split across WALK_THREADS threads.
+// Each thread starts at a chunk boundary recorded for one of WALK_STRIPES
+// equal stripes of the heap.
+#ifndef WALK_THREADS
+#define WALK_THREADS 4
+#endif
+
+#ifndef WALK_PARALLEL_MIN
+#define WALK_PARALLEL_MIN (64 << 20)
+#endif
+
+#define WALK_STRIPES 256
+#define WALK_STRIPE ((MEMLENGTH + WALK_STRIPES - 1) / WALK_STRIPES)
+
+// After mymalloc_shutdown(MYMALLOC_LEAKS_SAMPLE), the exit-time leak check
+// scans only the first 1/LEAK_SAMPLE of the heap
+#ifndef LEAK_SAMPLE
+#define LEAK_SAMPLE 16
+#endif
+
+// Chunks listed one by one in a signal-time dump; the rest are summarized
+#ifndef DUMP_MAX_CHUNKS
+#define DUMP_MAX_CHUNKS 1000
+#endif
+
+// With -DSIZE_CLASSES, small requests are rounded up to a size class from
+// the table generated by gen_size_classes, so a freed chunk fits any later
+// request of the same class exactly
+#ifdef SIZE_CLASSES
+#include "size_classes.h"
+_Static_assert(SIZE_CLASS_ALIGN == ALIGNMENT, "size_classes.h generated for another ALIGNMENT");
+#endif
+
+// With -DTELEMETRY, the allocator can export its stats through a shared
+// memory page (see telemetry.h)
+#ifdef TELEMETRY
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "telemetry.h"
+#endif
+
+#include <pthread.h>
+
 
 // Chunk structure
 typedef struct chunk {
     size_t size;      // Size of the payload area
-    int allocated;    // 1 if allocated, 0 if free
+    unsigned short allocated; // 1 if allocated, 0 if free (see chunk states)
+    unsigned short site;      // Interned id of the allocating call site
+    unsigned int requested; // Bytes the caller asked for (fits in the padding)
 } chunk_t;
 
+// Chunk states besides free (0) and allocated (1), used with -DBUMP
+enum {
+    CHUNK_BUMP_REGION = 2,  // A chunk holding a thread's bump region
+    CHUNK_BUMP_OBJECT = 3,  // Header of a live object inside a bump region
+    CHUNK_BUMP_FREED = 4    // Header of a freed object inside a bump region
+};
+
 static union {
     char bytes[MEMLENGTH];
     double not_used; 
@@ -63,6 +185,153 @@ static union {
 
 static int initialized = 0;
 
+// Every walk visits the chunks in address order, but the next header's
+// address comes from the size just read, so each step waits on the load
+// before it. The headers ahead lie at increasing addresses, though, so
+// fetching the heap a fixed distance ahead keeps them in flight; unlike the
+// hardware prefetchers, this also runs across page boundaries.
+static inline void prefetch_ahead(const chunk_t *current) {
+#if PREFETCH_AHEAD > 0
+    const char *ahead = (const char *)current + PREFETCH_AHEAD;
+    if (ahead < heap.bytes + MEMLENGTH) {
+        __builtin_prefetch(ahead);
+    }
+#else
+    (void)current;
+#endif
+}
+
+#ifdef PARALLEL_WALK
+// Offset of the first chunk header in each stripe, or MEMLENGTH if no
+// header starts in it. Kept current as headers are written and merged
+// away, so a walk can start at any stripe without walking up to it.
+static size_t stripe_first[WALK_STRIPES];
+#endif
+
+// Note a header just written at chunk
+static inline void stripe_added(const chunk_t *chunk) {
+#ifdef PARALLEL_WALK
+    size_t offset = (const char *)chunk - heap.bytes;
+    size_t *first = &stripe_first[offset / WALK_STRIPE];
+    if (offset < *first) {
+        *first = offset;
+    }
+#else
+    (void)chunk;
+#endif
+}
+
+// Note that the header at chunk is about to be merged into the chunk
+// before it; chunk->size must still be its own
+static inline void stripe_removed(const chunk_t *chunk) {
+#ifdef PARALLEL_WALK
+    size_t offset = (const char *)chunk - heap.bytes;
+    size_t stripe = offset / WALK_STRIPE;
+    if (stripe_first[stripe] == offset) {
+        size_t next = offset + sizeof(chunk_t) + chunk->size;
+        stripe_first[stripe] = next < MEMLENGTH && next / WALK_STRIPE == stripe ? next : MEMLENGTH;
+    }
+#else
+    (void)chunk;
+#endif
+}
+
+#ifdef BUMP
+// A bump region is one heap chunk marked CHUNK_BUMP_REGION. Its payload
+// starts with this header, followed by objects laid out back to back, each
+// behind a 16-byte bump_object_t. Objects are handed out by advancing top;
+// freeing the most recent one moves top back, and once none are live the
+// whole region is reused from the start. Objects freed out of order are only
+// reclaimed then. When its thread exits the region is marked orphaned, and
+// it goes back to the heap when its last object is freed, or if none is
+// live, the next time a first-fit search passes it. The exiting thread
+// cannot do this itself: it holds none of the caller's locks at that point.
+typedef struct bump_region {
+    char *top;      // Next free byte
+    char *end;      // End of the region
+    unsigned live;  // Objects allocated and not yet freed
+    unsigned orphaned;  // Set once the owning thread has exited
+} bump_region_t;
+
+typedef struct bump_object {
+    uint32_t size;       // Payload size
+    uint32_t region;     // Offset of the region's chunk, in ALIGNMENT units
+    unsigned short allocated;  // CHUNK_BUMP_OBJECT or CHUNK_BUMP_FREED
+    unsigned short site;
+    unsigned int requested;
+} bump_object_t;
+
+_Static_assert(sizeof(bump_object_t) == sizeof(chunk_t) &&
+               offsetof(bump_object_t, allocated) == offsetof(chunk_t, allocated),
+               "bump object headers must line up with chunk headers");
+
+static _Thread_local bump_region_t *my_region;
+static _Thread_local unsigned my_claim_backoff;  // Small requests left before retrying a claim
+static _Thread_local unsigned my_region_format;  // heap_formats when my_region was claimed
+static unsigned heap_formats;  // Times the heap has been formatted
+
+static bump_region_t *region_of_chunk(chunk_t *chunk) {
+    return (bump_region_t *)((char *)chunk + sizeof(chunk_t));
+}
+
+static char *region_base(bump_region_t *region) {
+    return (char *)(region + 1);
+}
+#endif
+
+// Operation counts, one block per thread on its own cache line so threads
+// never write to the same line; mymalloc_get_stats() adds the blocks up.
+// When a thread exits, its counts move to retired_stats and its block goes
+// on a free list for the next new thread.
+typedef struct thread_stats {
+    _Alignas(CACHE_LINE) size_t mallocs;
+    size_t frees;
+    size_t failed;
+    struct thread_stats *next_free;  // Free list link while no thread has it
+} thread_stats_t;
+
+static thread_stats_t thread_stats[MAX_STAT_THREADS];
+static thread_stats_t retired_stats;  // Counts of threads that have exited
+static unsigned stat_threads;  // Blocks handed out so far
+static thread_stats_t *free_stats;  // Blocks given back by exited threads
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t thread_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t thread_key;  // Runs thread_exit() for threads with a block
+static _Thread_local thread_stats_t *my_stats;
+
+// Live byte counts and their high-water marks. These are shared rather than
+// per thread: a peak is only exact if it is taken from the total. Like the
+// chunk headers, they change only under the caller's serialization of heap
+// operations; the relaxed atomic loads and stores (plain moves) just keep
+// readers such as the signal-time dump from seeing a torn value.
+static struct {
+    _Alignas(CACHE_LINE) ptrdiff_t requested;
+    ptrdiff_t held;
+    ptrdiff_t peak_requested;
+    ptrdiff_t peak_held;
+} live_usage;
+
+// Interned call sites; id 0 is the unknown site
+static mm_site_t *sites[MAX_SITES];
+static unsigned num_sites;
+
+// Set by mymalloc_shutdown()
+static int shutting_down;
+static mymalloc_leaks_t shutdown_leaks;
+
+// With no leak check to come, a free only validates its pointer: nothing is
+// counted or released, so the heap and the counters still agree
+#define FREES_IGNORED (shutting_down && shutdown_leaks == MYMALLOC_LEAKS_OFF)
+
+#ifdef TELEMETRY
+// Exported stats page; NULL unless MYMALLOC_TELEMETRY names a file
+static telemetry_page_t *telemetry;
+static long telemetry_interval = 1024;  // Operations between snapshots
+static long telemetry_ops;              // Operations since the last one
+static telemetry_latency_t malloc_latency;
+static telemetry_latency_t free_latency;
+#endif
+
 // Debug function to print messages if DEBUG is enabled
 void debug_print(const char* format, ...) {
     #if DEBUG
@@ -77,49 +346,255 @@ void debug_print(const char* format, ...) {
 
 // Helper function prototypes
 static void initialize_heap(void);
+static void release_chunk(chunk_t *chunk);
+#ifdef BUMP
+static void bump_thread_exit(void);
+#endif
 static void leak_detection(void);
+#ifdef LIFETIMES
+static void lifetime_exit_report(void);
+#endif
+#ifdef TELEMETRY
+static void telemetry_open(void);
+static void telemetry_publish(void);
+#endif
 
-// Initialize the heap with a single free chunk
-static void initialize_heap(void) {
-    debug_print("Initializing heap");
+// Turn the whole heap into a single free chunk
+static void format_heap(void) {
     chunk_t *init_chunk = (chunk_t *)heap.bytes;
     init_chunk->size = MEMLENGTH - sizeof(chunk_t);
     init_chunk->allocated = 0;
+    init_chunk->site = 0;
+    init_chunk->requested = 0;
+#ifdef BUMP
+    heap_formats++;
+#endif
+#ifdef PARALLEL_WALK
+    for (size_t i = 0; i < WALK_STRIPES; i++) {
+        stripe_first[i] = MEMLENGTH;
+    }
+#endif
+    stripe_added(init_chunk);
+}
+
+// Initialize the heap with a single free chunk. This runs as a constructor,
+// before main() and before C++ static constructors (which run at the default
+// priority), so malloc and free never have to check for it.
+__attribute__((constructor(101))) static void initialize_heap(void) {
+    if (initialized) {
+        return;
+    }
+    debug_print("Initializing heap");
+    format_heap();
     initialized = 1;
     
     // Register leak detection to run at program exit
     atexit(leak_detection);
-    debug_print("Heap initialized with a free chunk of size %zu bytes", init_chunk->size);
+#ifdef LIFETIMES
+    atexit(lifetime_exit_report);
+#endif
+#ifdef TELEMETRY
+    telemetry_open();
+#endif
+    debug_print("Heap initialized with a free chunk of size %zu bytes",
+                ((chunk_t *)heap.bytes)->size);
 }
 
-// Scan for leaks at program termination
-static void leak_detection(void) {
-    int leak_count = 0;
-    size_t leaked_bytes = 0;
-    
-    debug_print("Running leak detection");
-    
-    chunk_t* current = (chunk_t*)heap.bytes;
+// A constructor that runs before ours may check the heap before anything is
+// allocated; the cold entry points that walk it format it first. free() needs
+// no check: no valid pointer exists yet, and checked_chunk() rejects any
+// pointer into a zeroed heap as an invalid chunk header.
+static inline void require_heap(void) {
+    if (__builtin_expect(!initialized, 0)) {
+        initialize_heap();
+    }
+}
+
+// Give a site an id on its first allocation. The id is cached in the
+// descriptor, so this is a single load and compare afterwards.
+static unsigned short site_id(mm_site_t *site) {
+    if (site->id == 0) {
+        if (num_sites + 1 >= MAX_SITES) {
+            return 0;
+        }
+        sites[++num_sites] = site;
+        site->id = num_sites;
+    }
+    return site->id == MM_SITE_TRANSIENT ? 0 : site->id;
+}
+
+// What a walk over the heap adds up: the live objects, by call site, and
+// the free chunks. A bump region counts as the live objects inside it.
+typedef struct walk_totals {
+    size_t live_objects;
+    size_t live_bytes;
+    size_t free_chunks;
+    size_t free_bytes;
+    size_t largest_free;
+    size_t site_objects[MAX_SITES];
+    size_t site_bytes[MAX_SITES];
+} walk_totals_t;
+
+static void walk_live(walk_totals_t *totals, size_t size, unsigned short site) {
+    totals->live_objects++;
+    totals->live_bytes += size;
+    totals->site_objects[site]++;
+    totals->site_bytes[site] += size;
+}
+
+// Add up the chunks whose headers lie at offsets from..to; from must be
+// the offset of a header
+static void walk_chunks(size_t from, size_t to, walk_totals_t *totals) {
+    chunk_t *current = (chunk_t *)(heap.bytes + from);
     
-    while ((char*)current < heap.bytes + MEMLENGTH) {
+    while ((char *)current < heap.bytes + to) {
+        prefetch_ahead(current);
+#ifdef BUMP
+        if (current->allocated == CHUNK_BUMP_REGION) {
+            bump_region_t *region = region_of_chunk(current);
+            for (bump_object_t *object = (bump_object_t *)region_base(region);
+                 (char *)object < region->top;
+                 object = (bump_object_t *)((char *)(object + 1) + object->size)) {
+                if (object->allocated == CHUNK_BUMP_OBJECT) {
+                    walk_live(totals, object->size, object->site);
+                }
+            }
+        } else
+#endif
         if (current->allocated) {
-            leak_count++;
-            leaked_bytes += current->size;
-            debug_print("Found leaked chunk at %p, size %zu", current, current->size);
+            walk_live(totals, current->size, current->site);
+        } else {
+            totals->free_chunks++;
+            totals->free_bytes += current->size;
+            if (current->size > totals->largest_free) {
+                totals->largest_free = current->size;
+            }
         }
+        current = (chunk_t *)((char *)current + sizeof(chunk_t) + current->size);
+    }
+}
+
+#ifdef PARALLEL_WALK
+typedef struct walk_job {
+    pthread_t thread;
+    int started;
+    size_t from, to;
+    walk_totals_t totals;
+} walk_job_t;
+
+static void *walk_job(void *arg) {
+    walk_job_t *job = arg;
+    walk_chunks(job->from, job->to, &job->totals);
+    return NULL;
+}
+
+// Give each thread an equal run of stripes, starting at the first header
+// in its run, and add up what they find. The caller walks the first run
+// itself, and any run whose thread fails to start.
+static void walk_parallel(walk_totals_t *totals) {
+    static walk_job_t jobs[WALK_THREADS];
+    
+    for (unsigned t = 0; t < WALK_THREADS; t++) {
+        size_t first = WALK_STRIPES * t / WALK_THREADS;
+        size_t last = WALK_STRIPES * (t + 1) / WALK_THREADS;
+        walk_job_t *job = &jobs[t];
         
-        // Move to next chunk
-        current = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
-        
-        // Break if we've reached or exceeded the end of the heap
-        if ((char*)current >= heap.bytes + MEMLENGTH) {
-            break;
+        memset(&job->totals, 0, sizeof(job->totals));
+        job->to = last * WALK_STRIPE < MEMLENGTH ? last * WALK_STRIPE : MEMLENGTH;
+        job->from = job->to;
+        for (size_t stripe = first; stripe < last; stripe++) {
+            if (stripe_first[stripe] < job->to) {
+                job->from = stripe_first[stripe];
+                break;
+            }
+        }
+    }
+    for (unsigned t = 1; t < WALK_THREADS; t++) {
+        jobs[t].started = pthread_create(&jobs[t].thread, NULL, walk_job, &jobs[t]) == 0;
+    }
+    walk_job(&jobs[0]);
+    
+    for (unsigned t = 0; t < WALK_THREADS; t++) {
+        walk_job_t *job = &jobs[t];
+        if (t > 0 && job->started) {
+            pthread_join(job->thread, NULL);
+        } else if (t > 0) {
+            walk_job(job);
+        }
+        totals->live_objects += job->totals.live_objects;
+        totals->live_bytes += job->totals.live_bytes;
+        totals->free_chunks += job->totals.free_chunks;
+        totals->free_bytes += job->totals.free_bytes;
+        if (job->totals.largest_free > totals->largest_free) {
+            totals->largest_free = job->totals.largest_free;
         }
+        for (unsigned i = 0; i <= num_sites; i++) {
+            totals->site_objects[i] += job->totals.site_objects[i];
+            totals->site_bytes[i] += job->totals.site_bytes[i];
+        }
+    }
+}
+#endif
+
+// Walk the whole heap, in parallel if it is large enough (see WALK_THREADS)
+static void walk_heap(walk_totals_t *totals) {
+    memset(totals, 0, sizeof(*totals));
+#ifdef PARALLEL_WALK
+    if (MEMLENGTH >= WALK_PARALLEL_MIN) {
+        walk_parallel(totals);
+        return;
+    }
+#endif
+    walk_chunks(0, MEMLENGTH, totals);
+}
+
+// Scan for leaks at program termination
+static void leak_detection(void) {
+    static walk_totals_t totals;
+    size_t scanned = MEMLENGTH;
+    
+    if (shutting_down && shutdown_leaks == MYMALLOC_LEAKS_OFF) {
+        return;
+    }
+    if (shutting_down && shutdown_leaks == MYMALLOC_LEAKS_SAMPLE) {
+        scanned = MEMLENGTH / LEAK_SAMPLE;
+    }
+    
+    debug_print("Running leak detection");
+#ifdef TELEMETRY
+    // Leave the final state in the page for whoever reads it next
+    if (telemetry != NULL && scanned == MEMLENGTH) {
+        telemetry_publish();
+    }
+#endif
+    
+    if (scanned == MEMLENGTH) {
+        walk_heap(&totals);
+    } else {
+        memset(&totals, 0, sizeof(totals));
+        walk_chunks(0, scanned, &totals);
     }
     
-    if (leak_count > 0) {
-        fprintf(stderr, "mymalloc: %zu bytes leaked in %d objects.\n", 
-                leaked_bytes, leak_count);
+    if (totals.live_objects > 0 && scanned < MEMLENGTH) {
+        fprintf(stderr, "mymalloc: %zu bytes leaked in %zu objects in the first %zu bytes of the heap (sampled).\n",
+                totals.live_bytes, totals.live_objects, scanned);
+    } else if (totals.live_objects > 0) {
+        fprintf(stderr, "mymalloc: %zu bytes leaked in %zu objects.\n", 
+                totals.live_bytes, totals.live_objects);
+    }
+    if (totals.live_objects > 0) {
+        for (unsigned i = 0; i <= num_sites; i++) {
+            if (totals.site_objects[i] == 0) {
+                continue;
+            }
+            if (i == 0) {
+                fprintf(stderr, "mymalloc:   %zu bytes in %zu objects from unknown sites\n",
+                        totals.site_bytes[i], totals.site_objects[i]);
+            } else {
+                fprintf(stderr, "mymalloc:   %zu bytes in %zu objects from %s:%d\n",
+                        totals.site_bytes[i], totals.site_objects[i], sites[i]->file, sites[i]->line);
+            }
+        }
     } else {
         debug_print("No memory leaks detected");
     }
@@ -128,10 +603,12 @@ static void leak_detection(void) {
 // Function to dump heap state - helps with debugging
 void dump_heap() {
     printf("\n=== HEAP DUMP ===\n");
+    require_heap();
     chunk_t* current = (chunk_t*)heap.bytes;
     int count = 0;
     
     while ((char*)current < heap.bytes + MEMLENGTH) {
+        prefetch_ahead(current);
         printf("Chunk %d: addr=%p, size=%zu, allocated=%d, payload_addr=%p\n", 
                count++, current, current->size, current->allocated, 
                (void*)((char*)current + sizeof(chunk_t)));
@@ -147,20 +624,167 @@ void dump_heap() {
     printf("=== END HEAP DUMP ===\n\n");
 }
 
-void *mymalloc(size_t size, char *file, int line) {
-    // Initialize heap if needed
-    if (!initialized) {
-        initialize_heap();
+// Signal-safe heap dump. Only write(2) is used, through a small buffer
+// on the stack, and nothing is locked. The signal may arrive in the middle
+// of mymalloc() or myfree(), so the walk checks every header before it
+// follows it and stops where the heap is mid-update.
+typedef struct dump_buffer {
+    int fd;
+    size_t used;
+    char bytes[512];
+} dump_buffer_t;
+
+static void dump_flush(dump_buffer_t *out) {
+    size_t done = 0;
+    while (done < out->used) {
+        ssize_t n = write(out->fd, out->bytes + done, out->used - done);
+        if (n <= 0) {
+            break;
+        }
+        done += n;
+    }
+    out->used = 0;
+}
+
+static void dump_str(dump_buffer_t *out, const char *str) {
+    for (; *str != '\0'; str++) {
+        if (out->used == sizeof(out->bytes)) {
+            dump_flush(out);
+        }
+        out->bytes[out->used++] = *str;
     }
+}
+
+static void dump_num(dump_buffer_t *out, size_t value) {
+    char digits[24];
+    int i = sizeof(digits) - 1;
+    digits[i] = '\0';
+    do {
+        digits[--i] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    dump_str(out, digits + i);
+}
+
+// "name=value" with a leading space
+static void dump_field(dump_buffer_t *out, const char *name, size_t value) {
+    dump_str(out, " ");
+    dump_str(out, name);
+    dump_str(out, "=");
+    dump_num(out, value);
+}
+
+void mymalloc_dump(int fd) {
+    dump_buffer_t out = { fd, 0, {0} };
+    size_t free_bytes = 0, free_chunks = 0, largest_free = 0, chunks = 0;
+    mymalloc_stats_t stats;
     
-    debug_print("mymalloc(%zu) called from %s:%d", size, file, line);
+    mymalloc_get_stats(&stats);
+    dump_str(&out, "mymalloc heap dump\nstats");
+    dump_field(&out, "heap", MEMLENGTH);
+    dump_field(&out, "requested", stats.requested);
+    dump_field(&out, "held", stats.held);
+    dump_field(&out, "peak_held", stats.peak_held);
+    dump_field(&out, "mallocs", stats.mallocs);
+    dump_field(&out, "frees", stats.frees);
+    dump_field(&out, "failed", stats.failed);
+    dump_str(&out, "\n");
     
-    // Handle invalid size
-    if (size == 0) {
-        fprintf(stderr, "malloc: Unable to allocate 0 bytes (%s:%d)\n", file, line);
-        return NULL;
+    // Formatting the heap here would call atexit() and more, which a signal
+    // handler must not; a dump before the constructor just says so
+    chunk_t* current = (chunk_t*)heap.bytes;
+    if (!initialized) {
+        dump_str(&out, "heap not initialized\n");
+        current = (chunk_t*)(heap.bytes + MEMLENGTH);
+    }
+    while ((char*)current < heap.bytes + MEMLENGTH) {
+        prefetch_ahead(current);
+        size_t room = heap.bytes + MEMLENGTH - (char*)current;
+        if (room < sizeof(chunk_t) || current->size == 0 ||
+            current->size % ALIGNMENT != 0 || current->size > room - sizeof(chunk_t)) {
+            dump_str(&out, "walk stopped: chunk being updated");
+            dump_field(&out, "offset", (char*)current - heap.bytes);
+            dump_str(&out, "\n");
+            break;
+        }
+        
+        if (chunks++ < DUMP_MAX_CHUNKS) {
+#ifdef BUMP
+            if (current->allocated == CHUNK_BUMP_REGION) {
+                bump_region_t *region = region_of_chunk(current);
+                dump_str(&out, "chunk bump");
+                dump_field(&out, "offset", (char*)current - heap.bytes);
+                dump_field(&out, "size", current->size);
+                dump_field(&out, "live", region->live);
+                dump_str(&out, "\n");
+                current = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
+                continue;
+            }
+#endif
+            dump_str(&out, current->allocated ? "chunk used" : "chunk free");
+            dump_field(&out, "offset", (char*)current - heap.bytes);
+            dump_field(&out, "size", current->size);
+            if (current->allocated) {
+                unsigned short id = current->site;
+                dump_field(&out, "requested", current->requested);
+                if (id > 0 && id <= num_sites && sites[id] != NULL) {
+                    dump_str(&out, " site=");
+                    dump_str(&out, sites[id]->file);
+                    dump_str(&out, ":");
+                    dump_num(&out, sites[id]->line);
+                }
+            }
+            dump_str(&out, "\n");
+        }
+        if (!current->allocated) {
+            free_chunks++;
+            free_bytes += current->size;
+            if (current->size > largest_free) largest_free = current->size;
+        }
+        current = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
+    }
+    
+    if (chunks > DUMP_MAX_CHUNKS) {
+        dump_str(&out, "...");
+        dump_field(&out, "more_chunks", chunks - DUMP_MAX_CHUNKS);
+        dump_str(&out, "\n");
     }
+    dump_str(&out, "free");
+    dump_field(&out, "bytes", free_bytes);
+    dump_field(&out, "chunks", free_chunks);
+    dump_field(&out, "largest", largest_free);
+    dump_str(&out, "\nend of dump\n");
+    dump_flush(&out);
+}
+
+static volatile sig_atomic_t dump_fd = -1;
+
+static void dump_signal_handler(int signo) {
+    (void)signo;
+    // The interrupted code may be about to read errno, and write() can set it
+    int saved = errno;
+    mymalloc_dump(dump_fd);
+    errno = saved;
+}
+
+int mymalloc_dump_on_signal(int signo, int fd) {
+    struct sigaction action;
     
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = dump_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    dump_fd = fd;
+    return sigaction(signo, &action, NULL);
+}
+
+// Round a request up to the payload size of the chunk that will hold it
+static size_t adjust_size(size_t size) {
+#ifdef SIZE_CLASSES
+    if (size <= SIZE_CLASS_MAX) {
+        return size_class_payload[(size + ALIGNMENT - 1) / ALIGNMENT];
+    }
+#endif
     // Round up size to multiple of ALIGNMENT
     size_t aligned_size = (size + (ALIGNMENT - 1)) & ~(ALIGNMENT - 1);
     debug_print("Aligned size: %zu bytes", aligned_size);
@@ -170,74 +794,49 @@ void *mymalloc(size_t size, char *file, int line) {
         aligned_size = MIN_CHUNK_SIZE - sizeof(chunk_t);
         debug_print("Adjusted to minimum size: %zu bytes", aligned_size);
     }
-    
-    // Find a suitable free chunk
-    chunk_t* current = (chunk_t*)heap.bytes;
-    debug_print("Starting search for free chunk");
-    
-    while ((char*)current < heap.bytes + MEMLENGTH) {
-        debug_print("Examining chunk at %p, size: %zu, allocated: %d", 
-                   current, current->size, current->allocated);
-                   
-        if (!current->allocated && current->size >= aligned_size) {
-            debug_print("Found suitable free chunk at %p with size %zu", current, current->size);
-            
-            // Split the chunk if it's significantly larger than what we need
-            if (current->size >= aligned_size + sizeof(chunk_t) + MIN_CHUNK_SIZE) {
-                chunk_t* new_chunk = (chunk_t*)((char*)current + sizeof(chunk_t) + aligned_size);
-                size_t remaining_size = current->size - aligned_size - sizeof(chunk_t);
-                
-                debug_print("Splitting chunk. New free chunk at %p with size %zu", 
-                           new_chunk, remaining_size);
-                
-                new_chunk->size = remaining_size;
-                new_chunk->allocated = 0;
-                current->size = aligned_size;
-            }
-            
-            // Mark as allocated and return pointer to payload
-            current->allocated = 1;
-            void* payload = (void*)((char*)current + sizeof(chunk_t));
-            debug_print("Returning payload pointer %p", payload);
-            return payload;
-        }
-        
-        // Move to next chunk
-        chunk_t* next = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
-        
-        // Safety check to avoid infinite loops(since the first attempt implemntation had this issue)
-        if (next <= current || (char*)next >= heap.bytes + MEMLENGTH) {
-            debug_print("Warning: Invalid next chunk pointer. Breaking search loop.");
-            break;
-        }
-        
-        current = next;
-    }
-    
-    // No suitable chunk found
-    debug_print("No suitable free chunk found");
-    fprintf(stderr, "malloc: Unable to allocate %zu bytes (%s:%d)\n", size, file, line);
-    return NULL;
+    return aligned_size;
 }
 
-void myfree(void *ptr, char *file, int line) {
-    debug_print("myfree(%p) called from %s:%d", ptr, file, line);
-    
-    // Handle nulll pointer
-    if (ptr == NULL) {
-        debug_print("NULL pointer passed to free - nothing to do");
+// Shrink a chunk to aligned_size, turning the rest into a free chunk if it
+// is significantly larger than what we need. The new free chunk is merged
+// with the following chunk if that one is free too.
+static void split_chunk(chunk_t *current, size_t aligned_size) {
+    if (current->size < aligned_size + sizeof(chunk_t) + MIN_CHUNK_SIZE) {
         return;
     }
     
+    chunk_t* new_chunk = (chunk_t*)((char*)current + sizeof(chunk_t) + aligned_size);
+    size_t remaining_size = current->size - aligned_size - sizeof(chunk_t);
+    
+    debug_print("Splitting chunk. New free chunk at %p with size %zu", 
+               new_chunk, remaining_size);
+    
+    new_chunk->size = remaining_size;
+    new_chunk->allocated = 0;
+    new_chunk->requested = 0;
+    current->size = aligned_size;
+    stripe_added(new_chunk);
+    
+    chunk_t* next = (chunk_t*)((char*)new_chunk + sizeof(chunk_t) + new_chunk->size);
+    if ((char*)next < heap.bytes + MEMLENGTH && !next->allocated) {
+        debug_print("Coalescing split remainder with next chunk (size: %zu)", next->size);
+        stripe_removed(next);
+        new_chunk->size += sizeof(chunk_t) + next->size;
+    }
+}
+
+// Map a pointer passed to free()/realloc() back to its chunk header,
+// reporting and exiting if it does not point to an allocated chunk
+static chunk_t *checked_chunk(void *ptr, const char *op, const mm_site_t *site) {
     // Check if pointer is within heap bounds
     if ((char*)ptr < heap.bytes || (char*)ptr >= heap.bytes + MEMLENGTH) {
-        fprintf(stderr, "free: Inappropriate pointer, out of bounds (%s:%d)\n", file, line);
+        fprintf(stderr, "%s: Inappropriate pointer, out of bounds (%s:%d)\n", op, site->file, site->line);
         exit(2);
     }
     
     // check alignment
     if ((uintptr_t)ptr % ALIGNMENT != 0) {
-        fprintf(stderr, "free: Inappropriate pointer, misaligned (%s:%d)\n", file, line);
+        fprintf(stderr, "%s: Inappropriate pointer, misaligned (%s:%d)\n", op, site->file, site->line);
         exit(2);
     }
     
@@ -251,31 +850,627 @@ void myfree(void *ptr, char *file, int line) {
         (char*)chunk + sizeof(chunk_t) + chunk->size > heap.bytes + MEMLENGTH ||
         chunk->size == 0 || 
         chunk->size % ALIGNMENT != 0) {
-        fprintf(stderr, "free: Inappropriate pointer, invalid chunk header (%s:%d)\n", file, line);
+        fprintf(stderr, "%s: Inappropriate pointer, invalid chunk header (%s:%d)\n", op, site->file, site->line);
         exit(2);
     }
     
     // Check if already freed (double free)
     if (!chunk->allocated) {
-        fprintf(stderr, "free: Double free (%s:%d)\n", file, line);
+        fprintf(stderr, "%s: Double free (%s:%d)\n", op, site->file, site->line);
         exit(2);
     }
     
-    // Mark as free
-    chunk->allocated = 0;
-    debug_print("Chunk marked as free");
+    // A bump region's chunk is never handed out itself
+    if (chunk->allocated != 1) {
+        fprintf(stderr, "%s: Inappropriate pointer, misaligned (%s:%d)\n", op, site->file, site->line);
+        exit(2);
+    }
+    return chunk;
+}
+
+static void clear_counts(thread_stats_t *stats) {
+    stats->mallocs = 0;
+    stats->frees = 0;
+    stats->failed = 0;
+}
+
+// Thread exit: move the thread's counts to retired_stats and free its block.
+// A mymalloc_get_stats() running at that moment may see them in both.
+static void thread_exit(void *block) {
+    thread_stats_t *stats = block;
+#ifdef BUMP
+    bump_thread_exit();
+#endif
+    // A free in a later exit handler claims a block again
+    my_stats = NULL;
+    if (stats == &retired_stats) {
+        return;  // The thread shared the last block
+    }
+    pthread_mutex_lock(&stats_lock);
+    retired_stats.mallocs += stats->mallocs;
+    retired_stats.frees += stats->frees;
+    retired_stats.failed += stats->failed;
+    clear_counts(stats);
+    stats->next_free = free_stats;
+    free_stats = stats;
+    pthread_mutex_unlock(&stats_lock);
+}
+
+static void create_thread_key(void) {
+    pthread_key_create(&thread_key, thread_exit);
+}
+
+// The calling thread's counters, handing it a block on first use. Once all
+// MAX_STAT_THREADS blocks are taken, the thread shares the last one, and
+// keeps it when it exits.
+static thread_stats_t *claim_stats(void) {
+    thread_stats_t *stats;
     
-    // Try to coalesce with next chunk if it's free
-    chunk_t* next = (chunk_t*)((char*)chunk + sizeof(chunk_t) + chunk->size);
-    if ((char*)next < heap.bytes + MEMLENGTH) {
-        debug_print("Next chunk at %p, size: %zu, allocated: %d", 
-                   next, next->size, next->allocated);
-                   
-        if (!next->allocated) {
-            debug_print("Coalescing with next chunk (size: %zu)", next->size);
-            chunk->size += sizeof(chunk_t) + next->size;
-            debug_print("New size after forward coalescing: %zu", chunk->size);
-        }
+    pthread_once(&thread_key_once, create_thread_key);
+    pthread_mutex_lock(&stats_lock);
+    stats = free_stats;
+    if (stats != NULL) {
+        free_stats = stats->next_free;
+    } else if (stat_threads < MAX_STAT_THREADS) {
+        stats = &thread_stats[stat_threads];
+        __atomic_store_n(&stat_threads, stat_threads + 1, __ATOMIC_RELAXED);
+    }
+    pthread_mutex_unlock(&stats_lock);
+    
+    // The key is set either way, so thread_exit() runs for every thread
+    if (stats == NULL) {
+        my_stats = &thread_stats[MAX_STAT_THREADS - 1];
+        pthread_setspecific(thread_key, &retired_stats);
+    } else {
+        my_stats = stats;
+        pthread_setspecific(thread_key, stats);
+    }
+    return my_stats;
+}
+
+static inline thread_stats_t *stats_block(void) {
+    return my_stats != NULL ? my_stats : claim_stats();
+}
+
+static unsigned stat_blocks(void) {
+    return __atomic_load_n(&stat_threads, __ATOMIC_RELAXED);
+}
+
+// Add to a live byte count and raise its high-water mark
+static inline void count_live(ptrdiff_t *count, ptrdiff_t *peak, ptrdiff_t delta) {
+    ptrdiff_t now = __atomic_load_n(count, __ATOMIC_RELAXED) + delta;
+    __atomic_store_n(count, now, __ATOMIC_RELAXED);
+    if (now > __atomic_load_n(peak, __ATOMIC_RELAXED)) {
+        __atomic_store_n(peak, now, __ATOMIC_RELAXED);
+    }
+}
+
+static void count_usage(ptrdiff_t requested, ptrdiff_t held) {
+    count_live(&live_usage.requested, &live_usage.peak_requested, requested);
+    count_live(&live_usage.held, &live_usage.peak_held, held);
+}
+
+// Record a chunk that has just become allocated (or been resized in place)
+static void account_allocated(chunk_t *chunk, size_t size) {
+    chunk->requested = size > UINT_MAX ? UINT_MAX : size;
+    count_usage(chunk->requested, sizeof(chunk_t) + chunk->size);
+}
+
+static void account_released(chunk_t *chunk) {
+    count_usage(-(ptrdiff_t)chunk->requested, -(ptrdiff_t)(sizeof(chunk_t) + chunk->size));
+    chunk->requested = 0;
+}
+
+#ifdef LIFETIMES
+typedef struct lifetime_stats {
+    uint64_t freed;        // Objects freed
+    uint64_t short_lived;  // Of those, how many died within LIFETIME_SHORT ops
+    uint64_t total_ops;    // Sum of their lifetimes
+} lifetime_stats_t;
+
+// Operation count at which each chunk was allocated, indexed by the chunk's
+// offset in alignment units; the header has no room for it
+static uint32_t birth[MEMLENGTH / ALIGNMENT];
+static uint32_t lifetime_clock;
+static lifetime_stats_t site_lifetimes[MAX_SITES];
+static lifetime_stats_t class_lifetimes[LIFETIME_CLASSES];
+
+// header is the chunk header, or a bump object's header with -DBUMP
+static void lifetime_born(const void *header) {
+    birth[((const char *)header - heap.bytes) / ALIGNMENT] = ++lifetime_clock;
+}
+
+static void lifetime_add(lifetime_stats_t *stats, uint32_t ops) {
+    stats->freed++;
+    stats->total_ops += ops;
+    if (ops < LIFETIME_SHORT) {
+        stats->short_lived++;
+    }
+}
+
+static void lifetime_died(const void *header, size_t size, unsigned short site) {
+    uint32_t ops = ++lifetime_clock - birth[((const char *)header - heap.bytes) / ALIGNMENT];
+    int class = 0;
+    while (class < LIFETIME_CLASSES - 1 && ((size_t)16 << class) < size) {
+        class++;
+    }
+    lifetime_add(&site_lifetimes[site], ops);
+    lifetime_add(&class_lifetimes[class], ops);
+}
+
+static void lifetime_line(int fd, const char *name, const lifetime_stats_t *stats) {
+    dprintf(fd, "mymalloc:   %-36s %10llu %6.1f%% %10.1f\n", name,
+            (unsigned long long)stats->freed, 100.0 * stats->short_lived / stats->freed,
+            (double)stats->total_ops / stats->freed);
+}
+
+static int lifetime_candidate(const lifetime_stats_t *stats) {
+    return stats->freed >= LIFETIME_MIN_OBJECTS &&
+           stats->short_lived * 100 >= stats->freed * LIFETIME_CANDIDATE;
+}
+
+static void site_name(char *buf, size_t size, unsigned id) {
+    if (id == 0) {
+        snprintf(buf, size, "unknown");
+    } else {
+        snprintf(buf, size, "%s:%d", sites[id]->file, sites[id]->line);
+    }
+}
+
+void mymalloc_lifetime_report(int fd) {
+    char name[64];
+    
+    dprintf(fd, "mymalloc: object lifetimes in allocator operations, short-lived under %d\n",
+            LIFETIME_SHORT);
+    dprintf(fd, "mymalloc:   %-36s %10s %7s %10s\n", "site", "freed", "short", "mean");
+    for (unsigned id = 0; id <= num_sites; id++) {
+        if (site_lifetimes[id].freed > 0) {
+            site_name(name, sizeof(name), id);
+            lifetime_line(fd, name, &site_lifetimes[id]);
+        }
+    }
+    dprintf(fd, "mymalloc:   %-36s %10s %7s %10s\n", "size class", "freed", "short", "mean");
+    for (int class = 0; class < LIFETIME_CLASSES; class++) {
+        if (class_lifetimes[class].freed > 0) {
+            snprintf(name, sizeof(name), "<= %zu bytes", (size_t)16 << class);
+            lifetime_line(fd, name, &class_lifetimes[class]);
+        }
+    }
+    for (unsigned id = 0; id <= num_sites; id++) {
+        if (lifetime_candidate(&site_lifetimes[id])) {
+            site_name(name, sizeof(name), id);
+            dprintf(fd, "mymalloc: short-lived site %s: arena or stack allocation candidate\n", name);
+        }
+    }
+}
+
+static void lifetime_exit_report(void) {
+    mymalloc_lifetime_report(STDERR_FILENO);
+}
+#else
+void mymalloc_lifetime_report(int fd) {
+    dprintf(fd, "mymalloc: lifetime tracking not built in (compile with -DLIFETIMES)\n");
+}
+#endif
+
+#ifdef TELEMETRY
+static void telemetry_open(void) {
+    const char *path = getenv("MYMALLOC_TELEMETRY");
+    const char *interval = getenv("MYMALLOC_TELEMETRY_INTERVAL");
+    if (path == NULL || *path == '\0') {
+        return;
+    }
+    if (interval != NULL && atol(interval) > 0) {
+        telemetry_interval = atol(interval);
+    }
+    
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, TELEMETRY_PAGE_SIZE) != 0) {
+        fprintf(stderr, "mymalloc: cannot create telemetry page %s\n", path);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return;
+    }
+    void *page = mmap(NULL, TELEMETRY_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED) {
+        fprintf(stderr, "mymalloc: cannot map telemetry page %s\n", path);
+        return;
+    }
+    
+    telemetry = page;
+    telemetry->magic = TELEMETRY_MAGIC;
+    telemetry->version = TELEMETRY_VERSION;
+    telemetry->pid = getpid();
+    telemetry_publish();
+}
+
+static long telemetry_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+// Count one operation in its latency bucket, publishing every interval
+static void telemetry_record(telemetry_latency_t *latency, long start) {
+    long ns = telemetry_clock() - start;
+    int bucket = 0;
+    while (bucket < TELEMETRY_LATENCY_BUCKETS - 1 && ns >> (bucket + 1) > 0) {
+        bucket++;
+    }
+    latency->buckets[bucket]++;
+    latency->total_ns += ns;
+    
+    if (++telemetry_ops >= telemetry_interval) {
+        telemetry_publish();
+    }
+}
+
+// Keep the TELEMETRY_TOP_SITES sites with the most live bytes, largest first
+static void telemetry_rank_sites(telemetry_page_t *page, const size_t *objects,
+                                 const size_t *bytes) {
+    unsigned top[TELEMETRY_TOP_SITES];
+    unsigned n = 0;
+    
+    for (unsigned id = 0; id <= num_sites; id++) {
+        if (objects[id] == 0) {
+            continue;
+        }
+        unsigned pos = n < TELEMETRY_TOP_SITES ? n++ : TELEMETRY_TOP_SITES;
+        while (pos > 0 && bytes[top[pos - 1]] < bytes[id]) {
+            if (pos < TELEMETRY_TOP_SITES) {
+                top[pos] = top[pos - 1];
+            }
+            pos--;
+        }
+        if (pos < TELEMETRY_TOP_SITES) {
+            top[pos] = id;
+        }
+    }
+    
+    page->nsites = n;
+    for (unsigned i = 0; i < n; i++) {
+        telemetry_site_t *out = &page->top_sites[i];
+        const char *file = top[i] == 0 ? "unknown" : sites[top[i]]->file;
+        size_t len = strlen(file);
+        
+        // Keep the end of long paths, which names the file
+        if (len >= sizeof(out->file)) {
+            file += len - (sizeof(out->file) - 1);
+            len = sizeof(out->file) - 1;
+        }
+        memcpy(out->file, file, len + 1);
+        out->line = top[i] == 0 ? 0 : sites[top[i]]->line;
+        out->objects = objects[top[i]];
+        out->bytes = bytes[top[i]];
+    }
+}
+
+// Write a snapshot into the page under the sequence lock
+static void telemetry_publish(void) {
+    static walk_totals_t totals;
+    telemetry_page_t *page = telemetry;
+    mymalloc_stats_t stats;
+    
+    telemetry_ops = 0;
+    mymalloc_get_stats(&stats);
+    walk_heap(&totals);
+    
+    __atomic_store_n(&page->seq, page->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    
+    page->snapshots++;
+    page->heap_size = MEMLENGTH;
+    page->requested = stats.requested;
+    page->held = stats.held;
+    page->peak_requested = stats.peak_requested;
+    page->peak_held = stats.peak_held;
+    page->mallocs = stats.mallocs;
+    page->frees = stats.frees;
+    page->failed = stats.failed;
+    page->free_bytes = totals.free_bytes;
+    page->free_chunks = totals.free_chunks;
+    page->largest_free = totals.largest_free;
+    page->malloc_latency = malloc_latency;
+    page->free_latency = free_latency;
+    telemetry_rank_sites(page, totals.site_objects, totals.site_bytes);
+    
+    __atomic_store_n(&page->seq, page->seq + 1, __ATOMIC_RELEASE);
+}
+#endif
+
+// Find the first free chunk with at least aligned_size bytes of payload and
+// split off the rest; NULL if there is none
+#ifdef BUMP
+// Free an orphaned region with no live objects that a search came across,
+// merging it with its neighbours; prev is the chunk before it, or NULL.
+// Returns the free chunk that now covers it.
+static chunk_t *reclaim_region(chunk_t *chunk, chunk_t *prev) {
+    chunk->allocated = 0;
+    chunk_t *next = (chunk_t *)((char *)chunk + sizeof(chunk_t) + chunk->size);
+    if ((char *)next < heap.bytes + MEMLENGTH && !next->allocated) {
+        stripe_removed(next);
+        chunk->size += sizeof(chunk_t) + next->size;
+    }
+    if (prev != NULL && !prev->allocated) {
+        stripe_removed(chunk);
+        prev->size += sizeof(chunk_t) + chunk->size;
+        return prev;
+    }
+    return chunk;
+}
+
+static int region_abandoned(chunk_t *chunk) {
+    bump_region_t *region = region_of_chunk(chunk);
+    return chunk->allocated == CHUNK_BUMP_REGION && region->live == 0 &&
+           __atomic_load_n(&region->orphaned, __ATOMIC_RELAXED);
+}
+#endif
+
+static chunk_t *first_fit(size_t aligned_size) {
+    chunk_t* current = (chunk_t*)heap.bytes;
+#ifdef BUMP
+    chunk_t* prev = NULL;
+#endif
+    debug_print("Starting search for free chunk");
+    
+    while ((char*)current < heap.bytes + MEMLENGTH) {
+        prefetch_ahead(current);
+        debug_print("Examining chunk at %p, size: %zu, allocated: %d", 
+                   current, current->size, current->allocated);
+#ifdef BUMP
+        if (region_abandoned(current)) {
+            current = reclaim_region(current, prev);
+        }
+#endif
+                   
+        if (!current->allocated && current->size >= aligned_size) {
+            debug_print("Found suitable free chunk at %p with size %zu", current, current->size);
+            
+            // Split the chunk if it's significantly larger than what we need
+            split_chunk(current, aligned_size);
+            return current;
+        }
+        
+        // Move to next chunk
+        chunk_t* next = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
+        
+        // Safety check to avoid infinite loops(since the first attempt implemntation had this issue)
+        if (next <= current || (char*)next >= heap.bytes + MEMLENGTH) {
+            debug_print("Warning: Invalid next chunk pointer. Breaking search loop.");
+            break;
+        }
+        
+#ifdef BUMP
+        prev = current;
+#endif
+        current = next;
+    }
+    return NULL;
+}
+
+#ifdef BUMP
+// Carve the calling thread's region out of the heap; NULL if it is too full,
+// in which case the next BUMP_CLAIM_RETRY small requests skip the attempt
+static bump_region_t *bump_claim(void) {
+    chunk_t *chunk = first_fit(BUMP_REGION);
+    if (chunk == NULL) {
+        my_claim_backoff = BUMP_CLAIM_RETRY;
+        return NULL;
+    }
+    chunk->allocated = CHUNK_BUMP_REGION;
+    chunk->site = 0;
+    chunk->requested = 0;
+    
+    bump_region_t *region = region_of_chunk(chunk);
+    region->top = region_base(region);
+    region->end = (char *)region + chunk->size;
+    region->live = 0;
+    region->orphaned = 0;
+    my_region = region;
+    my_region_format = heap_formats;
+    return region;
+}
+
+// Thread exit: leave the region to be reclaimed (see bump_region_t). A
+// region from before a mymalloc_reset() went with the old heap.
+static void bump_thread_exit(void) {
+    bump_region_t *mine = my_region;
+    my_region = NULL;
+    if (mine != NULL && my_region_format == heap_formats) {
+        __atomic_store_n(&mine->orphaned, 1, __ATOMIC_RELAXED);
+    }
+}
+
+static void *bump_alloc(size_t size, mm_site_t *site) {
+    bump_region_t *region = my_region;
+    if (region == NULL) {
+        if (my_claim_backoff > 0) {
+            my_claim_backoff--;
+            return NULL;
+        }
+        region = bump_claim();
+    }
+    size_t payload = (size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1);
+    
+    if (region == NULL || (size_t)(region->end - region->top) < sizeof(bump_object_t) + payload) {
+        return NULL;
+    }
+    bump_object_t *object = (bump_object_t *)region->top;
+    object->size = payload;
+    object->region = ((char *)region - sizeof(chunk_t) - heap.bytes) / ALIGNMENT;
+    object->allocated = CHUNK_BUMP_OBJECT;
+    object->site = site_id(site);
+    object->requested = size;
+    region->top += sizeof(bump_object_t) + payload;
+    region->live++;
+#ifdef LIFETIMES
+    lifetime_born(object);
+#endif
+    
+    stats_block()->mallocs++;
+    count_usage(size, sizeof(bump_object_t) + payload);
+    return object + 1;
+}
+
+// The bump object ptr points to, or NULL if it is not one. The state in
+// the header could be user data, so the object must also lie in the region
+// its header names, and that must be a region chunk. A live object lies
+// below the region's top; a freed one may be past it once top rolls back,
+// and is still found so that a second free reports a double free.
+static bump_object_t *bump_object(void *ptr) {
+    if ((char *)ptr < heap.bytes + sizeof(chunk_t) || (char *)ptr >= heap.bytes + MEMLENGTH ||
+        (uintptr_t)ptr % ALIGNMENT != 0) {
+        return NULL;
+    }
+    bump_object_t *object = (bump_object_t *)ptr - 1;
+    if (object->allocated != CHUNK_BUMP_OBJECT && object->allocated != CHUNK_BUMP_FREED) {
+        return NULL;
+    }
+    size_t offset = (size_t)object->region * ALIGNMENT;
+    if (offset > MEMLENGTH - sizeof(chunk_t) - sizeof(bump_region_t)) {
+        return NULL;
+    }
+    chunk_t *chunk = (chunk_t *)(heap.bytes + offset);
+    bump_region_t *region = region_of_chunk(chunk);
+    char *limit = object->allocated == CHUNK_BUMP_OBJECT ? region->top : region->end;
+    if (chunk->allocated != CHUNK_BUMP_REGION ||
+        (char *)object < region_base(region) || (char *)ptr + object->size > limit) {
+        return NULL;
+    }
+    return object;
+}
+
+static void bump_free(bump_object_t *object, const mm_site_t *site) {
+    if (object->allocated == CHUNK_BUMP_FREED) {
+        fprintf(stderr, "free: Double free (%s:%d)\n", site->file, site->line);
+        exit(2);
+    }
+    if (FREES_IGNORED) {
+        return;
+    }
+    bump_region_t *region = region_of_chunk((chunk_t *)(heap.bytes + (size_t)object->region * ALIGNMENT));
+    
+    object->allocated = CHUNK_BUMP_FREED;
+    stats_block()->frees++;
+#ifdef LIFETIMES
+    lifetime_died(object, object->size, object->site);
+#endif
+    count_usage(-(ptrdiff_t)object->requested, -(ptrdiff_t)(sizeof(bump_object_t) + object->size));
+    
+    if (--region->live == 0 && __atomic_load_n(&region->orphaned, __ATOMIC_RELAXED)) {
+        release_chunk((chunk_t *)((char *)region - sizeof(chunk_t)));
+    } else if (region->live == 0) {
+        region->top = region_base(region);
+    } else if ((char *)(object + 1) + object->size == region->top) {
+        region->top = (char *)object;
+    }
+}
+#endif
+
+static void *malloc_chunk(size_t size, mm_site_t *site) {
+    debug_print("mymalloc(%zu) called from %s:%d", size, site->file, site->line);
+    
+    // Handle invalid size
+    if (size == 0) {
+        fprintf(stderr, "malloc: Unable to allocate 0 bytes (%s:%d)\n", site->file, site->line);
+        return NULL;
+    }
+    
+#ifdef BUMP
+    if (size <= BUMP_MAX) {
+        void *object = bump_alloc(size, site);
+        if (object != NULL) {
+            return object;
+        }
+    }
+#endif
+    
+    size_t aligned_size = adjust_size(size);
+    chunk_t *current = first_fit(aligned_size);
+    
+    if (current != NULL) {
+        // Mark as allocated and return pointer to payload
+        current->allocated = 1;
+        current->site = site_id(site);
+        stats_block()->mallocs++;
+#ifdef LIFETIMES
+        lifetime_born(current);
+#endif
+        account_allocated(current, size);
+        void* payload = (void*)((char*)current + sizeof(chunk_t));
+        debug_print("Returning payload pointer %p", payload);
+        return payload;
+    }
+    
+    // A constructor that ran before ours finds the heap still zeroed, and
+    // nothing fits in it; format it and try again
+    if (!initialized) {
+        initialize_heap();
+        return malloc_chunk(size, site);
+    }
+    
+    // No suitable chunk found
+    debug_print("No suitable free chunk found");
+    stats_block()->failed++;
+    fprintf(stderr, "malloc: Unable to allocate %zu bytes (%s:%d)\n", size, site->file, site->line);
+    return NULL;
+}
+
+static void free_chunk(void *ptr, mm_site_t *site) {
+    debug_print("myfree(%p) called from %s:%d", ptr, site->file, site->line);
+    
+    // Handle nulll pointer
+    if (ptr == NULL) {
+        debug_print("NULL pointer passed to free - nothing to do");
+        return;
+    }
+    
+#ifdef BUMP
+    bump_object_t *object = bump_object(ptr);
+    if (object != NULL) {
+        bump_free(object, site);
+        return;
+    }
+#endif
+    
+    chunk_t* chunk = checked_chunk(ptr, "free", site);
+    if (FREES_IGNORED) {
+        return;
+    }
+    
+    stats_block()->frees++;
+#ifdef LIFETIMES
+    lifetime_died(chunk, chunk->size, chunk->site);
+#endif
+    account_released(chunk);
+    release_chunk(chunk);
+}
+
+// Mark a chunk free and merge it with free neighbours
+static void release_chunk(chunk_t *chunk) {
+    chunk->allocated = 0;
+    debug_print("Chunk marked as free");
+    
+    // Try to coalesce with next chunk if it's free
+    chunk_t* next = (chunk_t*)((char*)chunk + sizeof(chunk_t) + chunk->size);
+    if ((char*)next < heap.bytes + MEMLENGTH) {
+        debug_print("Next chunk at %p, size: %zu, allocated: %d", 
+                   next, next->size, next->allocated);
+                   
+        if (!next->allocated) {
+            debug_print("Coalescing with next chunk (size: %zu)", next->size);
+            stripe_removed(next);
+            chunk->size += sizeof(chunk_t) + next->size;
+            debug_print("New size after forward coalescing: %zu", chunk->size);
+        }
+    }
+    
+    // During shutdown the chunk before is left alone: finding it takes a
+    // scan from the start of the heap, and little will be allocated again
+    if (shutting_down) {
+        return;
     }
     
     // coalesce with previous chunk if it's free
@@ -286,6 +1481,7 @@ void myfree(void *ptr, char *file, int line) {
     debug_print("Scanning for previous chunk to coalesce");
     
     while (scan != chunk && (char*)scan < heap.bytes + MEMLENGTH) {
+        prefetch_ahead(scan);
         chunk_t* next_scan = (chunk_t*)((char*)scan + sizeof(chunk_t) + scan->size);
         
         if (next_scan == chunk) {
@@ -306,6 +1502,7 @@ void myfree(void *ptr, char *file, int line) {
     
     if (prev != NULL && !prev->allocated) {
         debug_print("Coalescing with previous chunk (size: %zu)", prev->size);
+        stripe_removed(chunk);
         prev->size += sizeof(chunk_t) + chunk->size;
         debug_print("New size after backward coalescing: %zu", prev->size);
     }
@@ -313,4 +1510,290 @@ void myfree(void *ptr, char *file, int line) {
     debug_print("Free operation completed successfully");
 }
 
+void *mymalloc(size_t size, mm_site_t *site) {
+#ifdef TELEMETRY
+    if (telemetry != NULL) {
+        long start = telemetry_clock();
+        void *ptr = malloc_chunk(size, site);
+        telemetry_record(&malloc_latency, start);
+        return ptr;
+    }
+#endif
+    return malloc_chunk(size, site);
+}
+
+void myfree(void *ptr, mm_site_t *site) {
+#ifdef TELEMETRY
+    if (telemetry != NULL) {
+        long start = telemetry_clock();
+        free_chunk(ptr, site);
+        telemetry_record(&free_latency, start);
+        return;
+    }
+#endif
+    free_chunk(ptr, site);
+}
 
+void *myrealloc(void *ptr, size_t size, mm_site_t *site) {
+    debug_print("myrealloc(%p, %zu) called from %s:%d", ptr, size, site->file, site->line);
+    
+    if (ptr == NULL) {
+        return mymalloc(size, site);
+    }
+    
+#ifdef BUMP
+    // Bump objects never grow in place: move them
+    bump_object_t *object = bump_object(ptr);
+    if (object != NULL) {
+        if (object->allocated == CHUNK_BUMP_FREED) {
+            fprintf(stderr, "realloc: Double free (%s:%d)\n", site->file, site->line);
+            exit(2);
+        }
+        void *moved = size == 0 ? NULL : mymalloc(size, site);
+        if (moved != NULL) {
+            memcpy(moved, ptr, object->size < size ? object->size : size);
+        }
+        if (moved != NULL || size == 0) {
+            myfree(ptr, site);
+        }
+        return moved;
+    }
+#endif
+    
+    chunk_t* chunk = checked_chunk(ptr, "realloc", site);
+    
+    if (size == 0) {
+        myfree(ptr, site);
+        return NULL;
+    }
+    
+    size_t aligned_size = adjust_size(size);
+    
+    // Grow in place by absorbing the next chunk if it is free and big enough
+    if (aligned_size > chunk->size) {
+        chunk_t* next = (chunk_t*)((char*)chunk + sizeof(chunk_t) + chunk->size);
+        if ((char*)next < heap.bytes + MEMLENGTH && !next->allocated &&
+            chunk->size + sizeof(chunk_t) + next->size >= aligned_size) {
+            debug_print("Growing in place into next chunk (size: %zu)", next->size);
+            account_released(chunk);
+            stripe_removed(next);
+            chunk->size += sizeof(chunk_t) + next->size;
+            split_chunk(chunk, aligned_size);
+            account_allocated(chunk, size);
+            return ptr;
+        }
+        
+        // Otherwise move: allocate, copy, free
+        void* moved = mymalloc(size, site);
+        if (moved == NULL) {
+            return NULL;
+        }
+        memcpy(moved, ptr, chunk->size < size ? chunk->size : size);
+        myfree(ptr, site);
+        return moved;
+    }
+    
+    // Shrink (or keep) in place, returning the tail to the heap
+    account_released(chunk);
+    split_chunk(chunk, aligned_size);
+    account_allocated(chunk, size);
+    return ptr;
+}
+
+void *mycalloc(size_t count, size_t size, mm_site_t *site) {
+    debug_print("mycalloc(%zu, %zu) called from %s:%d", count, size, site->file, site->line);
+    
+    if (size != 0 && count > SIZE_MAX / size) {
+        fprintf(stderr, "calloc: Unable to allocate %zu x %zu bytes (%s:%d)\n",
+                count, size, site->file, site->line);
+        return NULL;
+    }
+    
+    void* ptr = mymalloc(count * size, site);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+// Operation counts are summed over the exited threads and every block; the
+// byte counts and their peaks come straight from the shared live_usage
+void mymalloc_get_stats(mymalloc_stats_t *out) {
+    unsigned n = stat_blocks();
+    
+    memset(out, 0, sizeof(*out));
+    out->mallocs = retired_stats.mallocs;
+    out->frees = retired_stats.frees;
+    out->failed = retired_stats.failed;
+    for (unsigned i = 0; i < n; i++) {
+        const thread_stats_t *t = &thread_stats[i];
+        out->mallocs += t->mallocs;
+        out->frees += t->frees;
+        out->failed += t->failed;
+    }
+    out->requested = __atomic_load_n(&live_usage.requested, __ATOMIC_RELAXED);
+    out->held = __atomic_load_n(&live_usage.held, __ATOMIC_RELAXED);
+    out->peak_requested = __atomic_load_n(&live_usage.peak_requested, __ATOMIC_RELAXED);
+    out->peak_held = __atomic_load_n(&live_usage.peak_held, __ATOMIC_RELAXED);
+    out->heap_size = MEMLENGTH;
+}
+
+void mymalloc_reset_peak(void) {
+    __atomic_store_n(&live_usage.peak_held, __atomic_load_n(&live_usage.held, __ATOMIC_RELAXED),
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&live_usage.peak_requested,
+                     __atomic_load_n(&live_usage.requested, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+}
+
+void mymalloc_shutdown(mymalloc_leaks_t leaks) {
+    const char *check = getenv("MYMALLOC_LEAK_CHECK");
+    if (check != NULL && strcmp(check, "full") == 0) {
+        return;
+    }
+    shutting_down = 1;
+    shutdown_leaks = leaks;
+}
+
+void mymalloc_reset(void) {
+    require_heap();
+    format_heap();
+    shutting_down = 0;
+    // Threads keep their blocks; only the counts start over
+    for (unsigned i = 0; i < MAX_STAT_THREADS; i++) {
+        clear_counts(&thread_stats[i]);
+    }
+    clear_counts(&retired_stats);
+    memset(&live_usage, 0, sizeof(live_usage));
+#ifdef BUMP
+    // The region went with the old heap; other threads' regions must not be
+    // used after a reset
+    my_region = NULL;
+    my_claim_backoff = 0;
+#endif
+#ifdef LIFETIMES
+    memset(site_lifetimes, 0, sizeof(site_lifetimes));
+    memset(class_lifetimes, 0, sizeof(class_lifetimes));
+#endif
+}
+
+// Report one integrity problem; returns 1 so callers can count them
+static int check_failed(const char *problem, const chunk_t *chunk) {
+    fprintf(stderr, "mymalloc: heap check failed: %s (chunk at offset %td)\n",
+            problem, (const char *)chunk - heap.bytes);
+    return 1;
+}
+
+#ifdef BUMP
+// Check the objects in a region, adding the live ones to the totals
+static int check_region(chunk_t *chunk, size_t *allocated, size_t *held, size_t *requested) {
+    bump_region_t *region = region_of_chunk(chunk);
+    char *end = (char *)chunk + sizeof(chunk_t) + chunk->size;
+    unsigned live = 0;
+    
+    if (region->end != end || region->top < region_base(region) || region->top > end) {
+        return check_failed("bump region header is corrupt", chunk);
+    }
+    for (bump_object_t *object = (bump_object_t *)region_base(region);
+         (char *)object < region->top;
+         object = (bump_object_t *)((char *)(object + 1) + object->size)) {
+        if ((char *)(object + 1) + object->size > region->top || object->size % ALIGNMENT != 0 ||
+            (object->allocated != CHUNK_BUMP_OBJECT && object->allocated != CHUNK_BUMP_FREED)) {
+            return check_failed("bump object header is corrupt", chunk);
+        }
+        if (object->allocated == CHUNK_BUMP_OBJECT) {
+            live++;
+            *held += sizeof(bump_object_t) + object->size;
+            *requested += object->requested;
+        }
+    }
+    *allocated += live;
+    return live == region->live ? 0 : check_failed("bump region live count is wrong", chunk);
+}
+#endif
+
+int mymalloc_check(void) {
+    require_heap();
+    
+    int problems = 0;
+    int prev_free = 0;
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    size_t allocated = 0, held = 0, requested = 0;
+    chunk_t* current = (chunk_t*)heap.bytes;
+#ifdef PARALLEL_WALK
+    size_t expected_first[WALK_STRIPES];
+    for (size_t i = 0; i < WALK_STRIPES; i++) {
+        expected_first[i] = MEMLENGTH;
+    }
+#endif
+    
+    while ((char*)current < heap.bytes + MEMLENGTH) {
+        prefetch_ahead(current);
+        // A bad size would make the rest of the walk meaningless
+        if (current->size == 0 || current->size % ALIGNMENT != 0) {
+            return problems + check_failed("chunk size is zero or misaligned", current);
+        }
+        if ((char*)current + sizeof(chunk_t) + current->size > heap.bytes + MEMLENGTH) {
+            return problems + check_failed("chunk runs past the end of the heap", current);
+        }
+#ifdef PARALLEL_WALK
+        size_t offset = (char*)current - heap.bytes;
+        if (expected_first[offset / WALK_STRIPE] == MEMLENGTH) {
+            expected_first[offset / WALK_STRIPE] = offset;
+        }
+#endif
+        
+#ifdef BUMP
+        if (current->allocated == CHUNK_BUMP_REGION) {
+            problems += check_region(current, &allocated, &held, &requested);
+            prev_free = 0;
+            current = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
+            continue;
+        }
+#endif
+        if (current->allocated != 0 && current->allocated != 1) {
+            problems += check_failed("allocated flag is corrupt", current);
+        }
+        if (current->allocated) {
+            allocated++;
+            held += sizeof(chunk_t) + current->size;
+            requested += current->requested;
+            if (current->requested > current->size) {
+                problems += check_failed("requested size exceeds payload", current);
+            }
+            prev_free = 0;
+        } else {
+            // Shutdown leaves freed chunks unmerged with the chunk before
+            if (prev_free && !shutting_down) {
+                problems += check_failed("adjacent free chunks were not coalesced", current);
+            }
+            prev_free = 1;
+        }
+        
+        current = (chunk_t*)((char*)current + sizeof(chunk_t) + current->size);
+    }
+    
+    if (allocated != stats.mallocs - stats.frees) {
+        problems += check_failed("allocated chunk count disagrees with counters", current);
+    }
+    if (held != stats.held || requested != stats.requested) {
+        problems += check_failed("allocated bytes disagree with counters", current);
+    }
+#ifdef PARALLEL_WALK
+    for (size_t i = 0; i < WALK_STRIPES; i++) {
+        if (stripe_first[i] != expected_first[i]) {
+            problems += check_failed("stripe index does not match the chunks", (chunk_t*)(heap.bytes + i * WALK_STRIPE));
+        }
+    }
+    // The walk in stripes must see exactly what one walk from the start sees
+    static walk_totals_t serial, striped;
+    memset(&serial, 0, sizeof(serial));
+    walk_chunks(0, MEMLENGTH, &serial);
+    memset(&striped, 0, sizeof(striped));
+    walk_parallel(&striped);
+    if (memcmp(&serial, &striped, sizeof(serial)) != 0) {
+        problems += check_failed("parallel walk disagrees with the serial walk", current);
+    }
+#endif
+    return problems;
+}
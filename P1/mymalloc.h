@@ -1,4 +1,87 @@
-#define malloc(X) mymalloc(X, __FILE__, __LINE__)
-#define free(X) myfree(X, __FILE__, __LINE__)
-void * mymalloc(size_t, char *, int);
-void myfree(void *, char *, int);
\ No newline at end of file
+#ifndef MYMALLOC_H
+#define MYMALLOC_H
+
+#include <stddef.h>
+#include "callsite.h"
+
+// Define MYMALLOC_NO_MACROS before including this header to call mymalloc()
+// and myfree() directly (passing MM_SITE()) while keeping the C library
+// malloc/free visible.
+#ifndef MYMALLOC_NO_MACROS
+#define malloc(X) mymalloc(X, MM_SITE())
+#define free(X) myfree(X, MM_SITE())
+#define realloc(X, Y) myrealloc(X, Y, MM_SITE())
+#define calloc(X, Y) mycalloc(X, Y, MM_SITE())
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void * mymalloc(size_t, mm_site_t *);
+void myfree(void *, mm_site_t *);
+void * myrealloc(void *, size_t, mm_site_t *);
+void * mycalloc(size_t, size_t, mm_site_t *);
+
+// Heap usage counters. "Held" bytes include chunk headers and alignment
+// padding, so held - requested is the allocator's overhead. Each thread
+// counts its operations into its own block and mymalloc_get_stats() adds
+// them up; the byte counts are shared, so the peaks are exact.
+typedef struct mymalloc_stats {
+    size_t requested;       // Bytes requested by live allocations
+    size_t held;            // Heap bytes occupied by live allocations
+    size_t peak_requested;  // High-water mark of requested
+    size_t peak_held;       // High-water mark of held
+    size_t mallocs;         // Successful mymalloc() calls
+    size_t frees;           // Successful myfree() calls
+    size_t failed;          // mymalloc() calls that returned NULL
+    size_t heap_size;       // Total heap size (MEMLENGTH)
+} mymalloc_stats_t;
+
+void mymalloc_get_stats(mymalloc_stats_t *stats);
+
+// Restart the high-water marks from the current usage
+void mymalloc_reset_peak(void);
+
+// Test hooks. mymalloc_reset() discards every allocation and returns the
+// heap and counters to their initial state. mymalloc_check() walks the heap
+// verifying chunk headers, coalescing and the counters; it prints each
+// problem to stderr and returns how many it found (0 if the heap is sound).
+void mymalloc_reset(void);
+int mymalloc_check(void);
+
+// Write the counters and a chunk-by-chunk heap listing to fd, using only
+// write(2), so it is safe to call from a signal handler. If it interrupts
+// an allocator call, the listing stops at the chunk being updated.
+// mymalloc_dump_on_signal() installs a handler that does this whenever
+// signo (e.g. SIGUSR1) arrives; it returns 0, or -1 if sigaction() failed.
+void mymalloc_dump(int fd);
+int mymalloc_dump_on_signal(int signo, int fd);
+
+// Fast shutdown. Call mymalloc_shutdown() when the program starts tearing
+// down. From then on, myfree() skips the scan for the chunk before the one
+// it frees, and the exit-time leak check does only what leaks asks for:
+//   MYMALLOC_LEAKS_FULL    scan the whole heap
+//   MYMALLOC_LEAKS_SAMPLE  scan only the start of the heap (a sixteenth by
+//                          default) and say so in the report
+//   MYMALLOC_LEAKS_OFF     no scan; myfree() only validates its pointer
+// With MYMALLOC_LEAK_CHECK=full in the environment the call does nothing,
+// so test runs keep every check. mymalloc_reset() leaves shutdown mode.
+typedef enum mymalloc_leaks {
+    MYMALLOC_LEAKS_FULL,
+    MYMALLOC_LEAKS_SAMPLE,
+    MYMALLOC_LEAKS_OFF
+} mymalloc_leaks_t;
+
+void mymalloc_shutdown(mymalloc_leaks_t leaks);
+
+// In builds with -DLIFETIMES, write how long objects lived (in allocator
+// operations) by call site and size class, naming the sites whose objects
+// are nearly all short-lived. The report is also written to stderr at exit.
+void mymalloc_lifetime_report(int fd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
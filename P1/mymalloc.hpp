@@ -0,0 +1,154 @@
+/**
+ *
+ * mymalloc.hpp: C++ interface to mymalloc
+ *
+ * Header-only layer so C++ code can allocate from the mymalloc heap without
+ * the malloc/free macros in mymalloc.h (which would clash with std::malloc,
+ * placement new and friends):
+ *
+ *   mm::resource()            a std::pmr::memory_resource over the heap
+ *   mm::allocator<T>          an STL allocator over the heap
+ *   mm::monotonic_resource    a std::pmr::monotonic_buffer_resource and
+ *   mm::pool_resource         a std::pmr::unsynchronized_pool_resource that
+ *                             take their blocks from the heap
+ *
+ * For example:
+ *
+ *   std::pmr::vector<int> v(mm::resource());
+ *   std::vector<int, mm::allocator<int>> w;
+ *   mm::pool_resource pool;
+ *   std::pmr::map<int, std::pmr::string> m(&pool);
+ *
+ * The heap hands out 8-byte aligned memory. Larger alignments are met by
+ * over-allocating and keeping the original pointer just below the aligned
+ * one. Allocation failure throws std::bad_alloc. Every allocation is
+ * reported to mymalloc as coming from this header, so error messages name
+ * mymalloc.hpp rather than the caller.
+ *
+ * Requires C++17.
+ */
+
+#ifndef MYMALLOC_HPP
+#define MYMALLOC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+
+#ifndef MYMALLOC_NO_MACROS
+#define MYMALLOC_NO_MACROS
+#endif
+#include "mymalloc.h"
+
+namespace mm {
+
+// Alignment of every pointer mymalloc() returns
+inline constexpr std::size_t heap_alignment = 8;
+
+inline void *allocate(std::size_t bytes, std::size_t alignment = heap_alignment) {
+    if (alignment <= heap_alignment) {
+        void *p = ::mymalloc(bytes ? bytes : 1, MM_SITE());
+        if (p == nullptr) throw std::bad_alloc();
+        return p;
+    }
+
+    // Over-aligned: the slack always leaves room for the original pointer
+    if (bytes > std::numeric_limits<std::size_t>::max() - alignment) throw std::bad_alloc();
+    void *raw = ::mymalloc(bytes + alignment, MM_SITE());
+    if (raw == nullptr) throw std::bad_alloc();
+    std::uintptr_t aligned = (reinterpret_cast<std::uintptr_t>(raw) + alignment) & ~(alignment - 1);
+    reinterpret_cast<void **>(aligned)[-1] = raw;
+    return reinterpret_cast<void *>(aligned);
+}
+
+inline void deallocate(void *p, std::size_t alignment = heap_alignment) noexcept {
+    if (p != nullptr && alignment > heap_alignment) {
+        p = static_cast<void **>(p)[-1];
+    }
+    ::myfree(p, MM_SITE());
+}
+
+// memory_resource over the mymalloc heap. There is one heap per process, so
+// every instance compares equal.
+class heap_resource : public std::pmr::memory_resource {
+protected:
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+        return mm::allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, std::size_t, std::size_t alignment) override {
+        mm::deallocate(p, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+        return dynamic_cast<const heap_resource *>(&other) != nullptr;
+    }
+};
+
+inline heap_resource *resource() noexcept {
+    static heap_resource instance;
+    return &instance;
+}
+
+// STL allocator over the mymalloc heap
+template <typename T>
+struct allocator {
+    using value_type = T;
+
+    allocator() noexcept = default;
+    template <typename U>
+    allocator(const allocator<U> &) noexcept {}
+
+    T *allocate(std::size_t n) {
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) throw std::bad_array_new_length();
+        return static_cast<T *>(mm::allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, std::size_t) noexcept {
+        mm::deallocate(p, alignof(T));
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const allocator<T> &, const allocator<U> &) noexcept { return true; }
+template <typename T, typename U>
+bool operator!=(const allocator<T> &, const allocator<U> &) noexcept { return false; }
+
+// Bump allocation from blocks taken from the heap; everything is released
+// at once when the resource is destroyed or release() is called
+class monotonic_resource : public std::pmr::monotonic_buffer_resource {
+public:
+    monotonic_resource() : std::pmr::monotonic_buffer_resource(resource()) {}
+    explicit monotonic_resource(std::size_t initial_size)
+        : std::pmr::monotonic_buffer_resource(initial_size, resource()) {}
+};
+
+// Pool sizes that fit the heap. The library defaults keep several KB of
+// pools and bookkeeping, more than the default 4096 byte heap holds, so
+// small heaps get a few small pools and larger blocks go straight to the
+// heap.
+inline std::pmr::pool_options default_pool_options() {
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    std::pmr::pool_options options;  // Zeros select the library defaults
+    if (stats.heap_size < (1 << 20)) {
+        options.max_blocks_per_chunk = stats.heap_size / 1024;
+        options.largest_required_pool_block = stats.heap_size / 64;
+    }
+    return options;
+}
+
+// Size-class pools carved from blocks taken from the heap. Not thread-safe,
+// like mymalloc itself.
+class pool_resource : public std::pmr::unsynchronized_pool_resource {
+public:
+    pool_resource() : std::pmr::unsynchronized_pool_resource(default_pool_options(), resource()) {}
+    explicit pool_resource(const std::pmr::pool_options &options)
+        : std::pmr::unsynchronized_pool_resource(options, resource()) {}
+};
+
+}  // namespace mm
+
+#endif
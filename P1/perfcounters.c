@@ -0,0 +1,91 @@
+/**
+ *
+ * perfcounters.c: Hardware performance counters around benchmark regions
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perfcounters.h"
+
+#define CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+    const char *name;
+    uint32_t type;
+    uint64_t config;
+} events[PERF_NEVENTS] = {
+    [PERF_CYCLES]        = {"cycles",   PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    [PERF_INSTRUCTIONS]  = {"instr",    PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    [PERF_L1D_MISSES]    = {"L1d-miss", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D)},
+    [PERF_LLC_MISSES]    = {"LLC-miss", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)},
+    [PERF_BRANCH_MISSES] = {"br-miss",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    [PERF_DTLB_MISSES]   = {"dTLB-miss", PERF_TYPE_HW_CACHE, CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)},
+};
+
+static int fds[PERF_NEVENTS] = {-1, -1, -1, -1, -1, -1};
+
+int perf_open(void) {
+    int available = 0;
+
+    for (int i = 0; i < PERF_NEVENTS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = events[i].type;
+        attr.config = events[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[i] >= 0) available++;
+    }
+    return available;
+}
+
+void perf_start(void) {
+    for (int i = 0; i < PERF_NEVENTS; i++) {
+        if (fds[i] < 0) continue;
+        ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void perf_stop(uint64_t values[PERF_NEVENTS]) {
+    for (int i = 0; i < PERF_NEVENTS; i++) {
+        if (fds[i] >= 0) ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for (int i = 0; i < PERF_NEVENTS; i++) {
+        // value, time enabled, time running
+        uint64_t data[3];
+
+        values[i] = PERF_UNAVAILABLE;
+        if (fds[i] < 0 || read(fds[i], data, sizeof(data)) != sizeof(data)) continue;
+
+        if (data[2] == 0) {
+            values[i] = 0;
+        } else if (data[2] < data[1]) {
+            values[i] = (uint64_t)((double)data[0] * data[1] / data[2]);
+        } else {
+            values[i] = data[0];
+        }
+    }
+}
+
+void perf_close(void) {
+    for (int i = 0; i < PERF_NEVENTS; i++) {
+        if (fds[i] >= 0) close(fds[i]);
+        fds[i] = -1;
+    }
+}
+
+const char *perf_event_name(int event) {
+    return events[event].name;
+}
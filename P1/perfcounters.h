@@ -0,0 +1,44 @@
+/**
+ *
+ * perfcounters.h: Hardware performance counters around benchmark regions
+ *
+ * Wraps Linux perf_event_open() for the calling thread, user space only.
+ * Each event is opened on its own, so events the CPU or kernel does not
+ * support (or that perf_event_paranoid forbids) are simply reported as
+ * unavailable while the rest keep working.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdint.h>
+
+enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_DTLB_MISSES,
+    PERF_NEVENTS
+};
+
+// Value reported for an event that could not be opened
+#define PERF_UNAVAILABLE UINT64_MAX
+
+// Open the counters; returns how many are available (0 if none)
+int perf_open(void);
+
+// Reset and enable every available counter
+void perf_start(void);
+
+// Disable the counters and read them into values[PERF_NEVENTS], scaled up
+// if the kernel had to multiplex them
+void perf_stop(uint64_t values[PERF_NEVENTS]);
+
+void perf_close(void);
+
+// Short column name for an event, e.g. "cycles"
+const char *perf_event_name(int event);
+
+#endif
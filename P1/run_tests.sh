@@ -1,28 +1,203 @@
 #!/bin/bash
-# Script to run all tests for mymalloc/myfree implementation
+# Test runner for the mymalloc/myfree implementation
+#
+# Every test has a time budget, an expected exit status and an optional
+# pattern that must appear on stderr (and one that must not appear on
+# stdout). Tests run in parallel; a summary is printed at the end and the
+# script exits with status 1 if any test failed, so it can gate commits.
+#
+# After the correctness tests, memgrind runs on its own and compares its
+# per-run timings against perf_baseline.txt (see memgrind -c). A workload
+# that is significantly slower by a Mann-Whitney test fails the run. Record
+# a baseline on the machine that runs the gate with --update-baseline.
+# PERF_RUNS (default 15) sets the number of samples per workload.
+#
+# Usage: ./run_tests.sh [-j JOBS] [-v] [--update-baseline] [--no-perf]
 
-echo "===== Running Validation Tests ====="
-./validation_test
-echo
+cd "$(dirname "$0")" || exit 1
 
-echo "===== Running Error Detection Tests ====="
-echo "Note: Each error test will cause program termination"
+JOBS=$(nproc 2>/dev/null || echo 2)
+VERBOSE=0
+UPDATE_BASELINE=0
+RUN_PERF=1
+BASELINE=perf_baseline.txt
+PERF_RUNS=${PERF_RUNS:-15}
 
-echo
-echo "----- Test 1: Freeing non-malloc address -----"
-./error_test 1
-echo
+while [ $# -gt 0 ]; do
+    case "$1" in
+        -j) JOBS=$2; shift ;;
+        -v) VERBOSE=1 ;;
+        --update-baseline) UPDATE_BASELINE=1 ;;
+        --no-perf) RUN_PERF=0 ;;
+        *) echo "Usage: $0 [-j JOBS] [-v] [--update-baseline] [--no-perf]" >&2; exit 2 ;;
+    esac
+    shift
+done
 
-echo "----- Test 2: Freeing offset pointer -----"
-./error_test 2
-echo
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
 
-echo "----- Test 3: Double-free detection -----"
-./error_test 3
-echo
+NAMES=()
+BUDGETS=()
+EXITS=()
+STDERR_PATTERNS=()
+STDOUT_FORBIDDEN=()
+COMMANDS=()
 
-echo "===== Running memgrind Performance Tests ====="
-./memgrind
-echo
+# add_test NAME BUDGET_SECONDS EXPECTED_EXIT STDERR_PATTERN STDOUT_FORBIDDEN COMMAND
+# Patterns are extended regular expressions; an empty pattern is not checked.
+add_test() {
+    NAMES+=("$1")
+    BUDGETS+=("$2")
+    EXITS+=("$3")
+    STDERR_PATTERNS+=("$4")
+    STDOUT_FORBIDDEN+=("$5")
+    COMMANDS+=("$6")
+}
+
+# Correctness tests
+add_test simple_malloc    10 0 "" "Failed" "./simple_malloc_test"
+add_test focused          10 0 "" "Failed" "./focused_test"
+add_test validation       10 0 "mymalloc: [0-9]+ bytes leaked in [0-9]+ objects" "FAILED" "./validation_test"
+add_test leak_sites       10 0 "^mymalloc:   160 bytes in 5 objects from validation_test\.c:[0-9]+$" "FAILED" "./validation_test"
+add_test thread_stats     10 0 "" "FAILED" "./thread_stats_test"
+add_test heap_dump        10 0 "" "FAILED" "./dump_test"
+add_test early_init       10 0 "" "FAILED" "./early_init_test"
+add_test scratch          10 0 "" "FAILED" "./scratch_test"
+add_test shutdown         10 0 "^mymalloc: 96 bytes leaked in 3 objects in the first [0-9]+ bytes of the heap \(sampled\)\.$" "FAILED" "./shutdown_test"
+add_test shutdown_full    10 0 "^mymalloc: 96 bytes leaked in 3 objects\.$" "FAILED" "MYMALLOC_LEAK_CHECK=full ./shutdown_test"
+add_test shutdown_bad_free 10 2 "^free: Inappropriate pointer, misaligned \(shutdown_test\.c:[0-9]+\)$" "ERROR:" "./shutdown_test bad_free"
+add_test lifetimes        10 0 "^mymalloc: short-lived site lifetime_test\.c:[0-9]+:" "FAILED" "./lifetime_test"
+
+# Error detection: each case must terminate with exit(2) and the right message
+add_test error_usage      10 0 "" "" "./error_test"
+add_test error_invalid    10 1 "" "" "./error_test 9"
+add_test error_non_malloc 10 2 "^free: Inappropriate pointer, out of bounds \(error_test\.c:[0-9]+\)$" "ERROR:" "./error_test 1"
+add_test error_offset     10 2 "^free: Inappropriate pointer, misaligned \(error_test\.c:[0-9]+\)$" "ERROR:" "./error_test 2"
+add_test error_double     10 2 "^free: Double free \(error_test\.c:[0-9]+\)$" "ERROR:" "./error_test 3"
+
+# Compile-time configured heaps (heap.hpp) and their C wrappers
+add_test heap_template    10 0 "" "FAILED" "./heap_test"
+
+# C++ layer (mymalloc.hpp): containers on every resource, heap empty after
+add_test cxx_adapter      30 0 "" "FAILED" "./cxxbench -r 100"
+
+# Randomized tests
+add_test fuzz_test        60 0 "" "" "./fuzz_test -n 200000 -S 1 && ./fuzz_test -n 200000"
+add_test fuzz_classes     60 0 "" "" "./fuzz_test_classes -n 200000 -S 1"
+add_test fuzz_bump        60 0 "" "" "./fuzz_test_bump -n 200000 -S 1 && ./fuzz_test_bump -n 200000"
+add_test bump             10 0 "" "FAILED" "./bump_test"
+add_test bump_interior    10 2 "^free: Inappropriate pointer, invalid chunk header \(bump_test\.c:[0-9]+\)$" "ERROR:" "./bump_test interior"
+add_test telemetry        30 0 "" "" "MYMALLOC_TELEMETRY=\$TEST_TMP/page ./fuzz_test_telemetry -n 20000 -S 1 && ./telemetry_read \$TEST_TMP/page | grep -q '^mymalloc_mallocs_total [1-9]'"
+add_test fuzz_corpus      60 0 "" "" "./fuzz_corpus \$TEST_TMP && ./fuzz_target \$TEST_TMP"
+add_test parallel_walk    60 0 "" "" "./fuzz_corpus \$TEST_TMP && ./fuzz_target_parallel \$TEST_TMP"
+
+# Run test $1 and write its verdict to $WORK/$1.result
+run_test() {
+    local i=$1
+    local out=$WORK/$i.out err=$WORK/$i.err
+    local start end status reason=""
 
-echo "All tests completed."
\ No newline at end of file
+    mkdir -p "$WORK/$i.tmp"
+    start=$(date +%s.%N)
+    TEST_TMP=$WORK/$i.tmp timeout -k 5 "${BUDGETS[$i]}" bash -c "${COMMANDS[$i]}" >"$out" 2>"$err"
+    status=$?
+    end=$(date +%s.%N)
+
+    if [ $status -eq 124 ] || [ $status -eq 137 ]; then
+        reason="exceeded time budget of ${BUDGETS[$i]}s"
+    elif [ $status -ne "${EXITS[$i]}" ]; then
+        reason="expected exit status ${EXITS[$i]}, got $status"
+    elif [ -n "${STDERR_PATTERNS[$i]}" ] && ! grep -Eq "${STDERR_PATTERNS[$i]}" "$err"; then
+        reason="stderr does not match /${STDERR_PATTERNS[$i]}/"
+    elif [ -n "${STDOUT_FORBIDDEN[$i]}" ] && grep -Eq "${STDOUT_FORBIDDEN[$i]}" "$out"; then
+        reason="stdout contains /${STDOUT_FORBIDDEN[$i]}/"
+    fi
+
+    printf "%s\n%s\n" "$reason" "$(awk -v s="$start" -v e="$end" 'BEGIN { printf "%.2f", e - s }')" >"$WORK/$i.result"
+}
+
+report_test() {
+    local i=$1
+    local reason elapsed
+    reason=$(sed -n 1p "$WORK/$i.result")
+    elapsed=$(sed -n 2p "$WORK/$i.result")
+
+    if [ -z "$reason" ]; then
+        printf "PASS  %-18s (%ss)\n" "${NAMES[$i]}" "$elapsed"
+    else
+        printf "FAIL  %-18s (%ss): %s\n" "${NAMES[$i]}" "$elapsed" "$reason"
+        FAILED+=("${NAMES[$i]}")
+    fi
+    if [ -n "$reason" ] || [ $VERBOSE -eq 1 ]; then
+        echo "      command: ${COMMANDS[$i]}"
+        echo "      --- stdout (last 10 lines) ---"
+        tail -n 10 "$WORK/$i.out" | sed 's/^/      /'
+        echo "      --- stderr (last 10 lines) ---"
+        tail -n 10 "$WORK/$i.err" | sed 's/^/      /'
+    fi
+}
+
+FAILED=()
+
+echo "===== Building ====="
+if ! make -s all >"$WORK/build.log" 2>&1; then
+    cat "$WORK/build.log"
+    echo "FAIL  build"
+    exit 1
+fi
+
+echo "===== Running ${#NAMES[@]} tests ($JOBS at a time) ====="
+running=0
+for i in "${!NAMES[@]}"; do
+    if [ $running -ge "$JOBS" ]; then
+        wait -n
+        running=$((running - 1))
+    fi
+    run_test "$i" &
+    running=$((running + 1))
+done
+wait
+
+for i in "${!NAMES[@]}"; do
+    report_test "$i"
+done
+
+# Throughput check, run alone so the timings are not disturbed. memgrind
+# does the comparison itself and exits with status 3 on a slowdown.
+if [ $RUN_PERF -eq 1 ]; then
+    echo
+    echo "===== Checking memgrind throughput ====="
+    PERF_ARGS=(-w all -n 20000 -r "$PERF_RUNS" -S 1)
+    if [ $UPDATE_BASELINE -eq 1 ]; then
+        if timeout 600 ./memgrind "${PERF_ARGS[@]}" -b "$BASELINE" >"$WORK/perf.out" 2>&1; then
+            echo "Baseline written to $BASELINE"
+        else
+            echo "FAIL  memgrind did not complete"
+            tail -n 10 "$WORK/perf.out"
+            FAILED+=("memgrind")
+        fi
+    elif [ ! -f "$BASELINE" ]; then
+        echo "SKIP  no $BASELINE; run with --update-baseline to record one"
+    else
+        timeout 600 ./memgrind "${PERF_ARGS[@]}" -c "$BASELINE" >"$WORK/perf.out" 2>&1
+        status=$?
+        # Print just the comparison table
+        sed -n '/^Comparison with baseline/,$p' "$WORK/perf.out"
+        if [ $status -eq 3 ]; then
+            FAILED+=("throughput")
+        elif [ $status -ne 0 ]; then
+            echo "FAIL  memgrind exited with status $status"
+            tail -n 10 "$WORK/perf.out"
+            FAILED+=("memgrind")
+        fi
+    fi
+fi
+
+echo
+if [ ${#FAILED[@]} -eq 0 ]; then
+    echo "All tests passed."
+    exit 0
+fi
+echo "${#FAILED[@]} failed: ${FAILED[*]}"
+exit 1
@@ -0,0 +1,91 @@
+#!/bin/bash
+# Scalability sweep: throughput against heap size and live-object count
+#
+# Rebuilds scalebench (see scalebench.c) for every heap size from 4 KB to
+# 1 GB, runs it over live-object counts from 10 to 10M, and collects the
+# results in one CSV file. If gnuplot is installed the results are also
+# plotted, one line per allocator and heap size, with ops/sec against live
+# objects on log-log axes; otherwise a table is printed.
+#
+# Usage: ./scalability.sh [-a LIST] [-t SECONDS] [-o FILE]
+#
+#   -a LIST     allocators to compare (default "mymalloc,system")
+#   -t SECONDS  time budget per point (default 2)
+#   -o FILE     CSV output (default scalability.csv); the plot goes next to
+#               it with a .png extension
+
+cd "$(dirname "$0")" || exit 1
+
+ALLOCATORS=mymalloc,system
+BUDGET=2
+OUT=scalability.csv
+HEAP_SIZES="4096 65536 1048576 16777216 268435456 1073741824"
+
+while getopts "a:t:o:" opt; do
+    case $opt in
+        a) ALLOCATORS=$OPTARG ;;
+        t) BUDGET=$OPTARG ;;
+        o) OUT=$OPTARG ;;
+        *) echo "Usage: $0 [-a LIST] [-t SECONDS] [-o FILE]" >&2; exit 2 ;;
+    esac
+done
+
+echo "allocator,heap_bytes,live,ops,ops_per_sec,failed,status" >"$OUT"
+for heap in $HEAP_SIZES; do
+    echo "Heap of $heap bytes..."
+    if ! make -s "scalebench-$heap"; then
+        echo "Build failed for a heap of $heap bytes" >&2
+        exit 1
+    fi
+    # Allocation failures are expected near capacity; keep them off the console
+    ./"scalebench-$heap" -a "$ALLOCATORS" -t "$BUDGET" 2>/dev/null >>"$OUT"
+done
+echo "Results written to $OUT"
+
+# Table: ops/sec per allocator and heap size (rows) and live count (columns)
+awk -F, '
+    NR == 1 { next }
+    {
+        row = $1 " " $2
+        if (!(row in seen)) { seen[row] = 1; rows[++nrows] = row }
+        if (!($3 in cols)) { cols[$3] = 1; order[++ncols] = $3 }
+        value[row, $3] = $7 == "ok" ? sprintf("%.2e", $5) : $7
+    }
+    END {
+        printf "%-30s", "allocator heap_bytes \\ live"
+        for (c = 1; c <= ncols; c++) printf " %9s", order[c]
+        printf "\n"
+        for (r = 1; r <= nrows; r++) {
+            printf "%-30s", rows[r]
+            for (c = 1; c <= ncols; c++) {
+                v = (rows[r], order[c]) in value ? value[rows[r], order[c]] : "-"
+                printf " %9s", v
+            }
+            printf "\n"
+        }
+    }' "$OUT"
+
+if command -v gnuplot >/dev/null; then
+    PLOT=${OUT%.csv}.png
+    series=$(awk -F, 'NR > 1 && !seen[$1 "," $2]++ { print $1 "," $2 }' "$OUT")
+    {
+        echo "set terminal png size 1200,800"
+        echo "set output '$PLOT'"
+        echo "set datafile separator ','"
+        echo "set logscale xy"
+        echo "set xlabel 'live objects'"
+        echo "set ylabel 'ops/sec'"
+        echo "set key outside right"
+        printf "plot "
+        first=1
+        for s in $series; do
+            [ $first -eq 0 ] && printf ", "
+            first=0
+            alloc=${s%,*}
+            heap=${s#*,}
+            printf "'%s' using (strcol(1) eq '%s' && \$2 == %s && strcol(7) eq 'ok' ? \$3 : NaN):5 with linespoints title '%s %s'" \
+                "$OUT" "$alloc" "$heap" "$alloc" "$heap"
+        done
+        echo
+    } | gnuplot && echo "Plot written to $PLOT"
+fi
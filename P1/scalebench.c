@@ -0,0 +1,222 @@
+/**
+ *
+ * scalebench.c: Throughput against heap size and live-object count
+ *
+ * The heap size is fixed at compile time (MEMLENGTH), so this program
+ * measures one heap size per build; scalability.sh rebuilds it for every
+ * size from 4 KB to 1 GB and collects the results.
+ *
+ * For each live-object count, the heap is filled with that many objects of
+ * random size (16 to 64 bytes), then a steady-state loop frees a random
+ * object and allocates a replacement. Throughput is the number of those
+ * operations per second. A first-fit allocator walks every chunk before the
+ * fit, so its throughput falls as the live count grows; allocators with
+ * constant-time lookup stay flat.
+ *
+ * Each point has a time budget covering both the fill and the timed loop.
+ * Once a point runs out of budget during the fill, or the heap cannot hold
+ * the objects, larger live counts are skipped for that allocator.
+ *
+ * Usage: ./scalebench [-a LIST] [-l LIST] [-n OPS] [-t SECONDS] [-S SEED] [-H]
+ *
+ *   -a LIST     allocators to measure (see allocators.h; default mymalloc)
+ *   -l LIST     comma-separated live-object counts
+ *               (default 10,100,1000,10000,100000,1000000,10000000)
+ *   -n OPS      maximum timed operations per point (default 1000000)
+ *   -t SECONDS  time budget per point (default 2)
+ *   -S SEED     random seed (default 1)
+ *   -H          print a CSV header line first
+ *
+ * Output is CSV, one line per allocator and live count:
+ *
+ *   allocator,heap_bytes,live,ops,ops_per_sec,failed,status
+ *
+ * where status is "ok", "budget" (the fill did not finish in time), or
+ * "full" (the heap could not hold the objects).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "allocators.h"
+#define MYMALLOC_NO_MACROS
+#include "mymalloc.h"
+
+#define MAX_ALLOCATORS 8
+#define MAX_COUNTS 32
+#define MIN_OBJECT 16
+#define MAX_OBJECT 64
+#define CHUNK_HEADER 16
+
+static unsigned long long rng_state;
+
+static unsigned long next_rand(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned long)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+static size_t random_size(void) {
+    return MIN_OBJECT + next_rand() % (MAX_OBJECT - MIN_OBJECT + 1);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Drop every object. mymalloc has a reset hook, which avoids the O(n)
+// backward scan myfree() would do for each one.
+static void release_all(const allocator_t *alloc, void **slots, long live) {
+    if (strcmp(alloc->name, "mymalloc") == 0) {
+        mymalloc_reset();
+        return;
+    }
+    for (long i = 0; i < live; i++) {
+        alloc->free(slots[i]);
+    }
+}
+
+// Measure one point; returns 0 if larger live counts are worth trying
+static int measure(const allocator_t *alloc, long live, long max_ops, double budget) {
+    mymalloc_stats_t stats;
+    mymalloc_get_stats(&stats);
+    const char *status = "ok";
+    long ops = 0, failed = 0;
+    double rate = 0.0;
+
+    // The template heaps may be smaller than mymalloc's (see the Makefile);
+    // backends without counters are listed against mymalloc's heap size
+    if (alloc->usage != NULL) {
+        allocator_usage_t usage;
+        alloc->usage(&usage);
+        stats.heap_size = usage.heap_size;
+    }
+
+    // Skip what cannot fit in mymalloc's heap without trying
+    if (strcmp(alloc->name, "mymalloc") == 0
+        && (size_t)live * (CHUNK_HEADER + (MIN_OBJECT + MAX_OBJECT) / 2) > stats.heap_size) {
+        printf("%s,%zu,%ld,0,0,0,full\n", alloc->name, stats.heap_size, live);
+        return -1;
+    }
+
+    void **slots = calloc(live, sizeof(void *));
+    if (slots == NULL) {
+        printf("%s,%zu,%ld,0,0,0,full\n", alloc->name, stats.heap_size, live);
+        return -1;
+    }
+
+    double start = now_seconds();
+    long filled;
+    for (filled = 0; filled < live; filled++) {
+        if (filled % 1024 == 0 && now_seconds() - start > budget) {
+            status = "budget";
+            break;
+        }
+        slots[filled] = alloc->malloc(random_size());
+        if (slots[filled] == NULL) {
+            status = "full";
+            break;
+        }
+    }
+
+    if (filled == live) {
+        double deadline = start + budget;
+        double loop_start = now_seconds();
+        double end = loop_start;
+
+        while (ops < max_ops) {
+            if (ops % 256 == 0 && (end = now_seconds()) > deadline) break;
+            long i = next_rand() % live;
+            alloc->free(slots[i]);
+            slots[i] = alloc->malloc(random_size());
+            if (slots[i] == NULL) {
+                // Fragmentation: retry the smallest size so the slot stays live
+                failed++;
+                slots[i] = alloc->malloc(MIN_OBJECT);
+                if (slots[i] == NULL) {
+                    status = "full";
+                    break;
+                }
+            }
+            ops += 2;
+        }
+        end = now_seconds();
+        rate = end > loop_start ? ops / (end - loop_start) : 0.0;
+    }
+
+    printf("%s,%zu,%ld,%ld,%.0f,%ld,%s\n", alloc->name, stats.heap_size,
+           live, ops, rate, failed, status);
+    fflush(stdout);
+
+    release_all(alloc, slots, filled);
+    free(slots);
+    return strcmp(status, "ok") == 0 ? 0 : -1;
+}
+
+int main(int argc, char *argv[]) {
+    const allocator_t *allocators[MAX_ALLOCATORS];
+    long counts[MAX_COUNTS] = {10, 100, 1000, 10000, 100000, 1000000, 10000000};
+    int nallocators = 0, ncounts = 7;
+    long max_ops = 1000000;
+    double budget = 2.0;
+    unsigned long seed = 1;
+    int header = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:l:n:t:S:H")) != -1) {
+        switch (opt) {
+        case 'a':
+            for (char *spec = strtok(optarg, ","); spec != NULL; spec = strtok(NULL, ",")) {
+                const allocator_t *a = find_allocator(spec);
+                if (a == NULL) return 1;
+                if (nallocators < MAX_ALLOCATORS) allocators[nallocators++] = a;
+            }
+            break;
+        case 'l':
+            ncounts = 0;
+            for (char *n = strtok(optarg, ","); n != NULL && ncounts < MAX_COUNTS; n = strtok(NULL, ",")) {
+                counts[ncounts] = atol(n);
+                if (counts[ncounts] <= 0) {
+                    fprintf(stderr, "scalebench: bad live count '%s'\n", n);
+                    return 1;
+                }
+                ncounts++;
+            }
+            break;
+        case 'n':
+            max_ops = atol(optarg);
+            break;
+        case 't':
+            budget = atof(optarg);
+            break;
+        case 'S':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'H':
+            header = 1;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-a LIST] [-l LIST] [-n OPS] [-t SECONDS] [-S SEED] [-H]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (nallocators == 0) {
+        allocators[nallocators++] = find_allocator("mymalloc");
+    }
+
+    if (header) {
+        printf("allocator,heap_bytes,live,ops,ops_per_sec,failed,status\n");
+    }
+    for (int a = 0; a < nallocators; a++) {
+        rng_state = seed ? seed : 1;
+        for (int c = 0; c < ncounts; c++) {
+            if (measure(allocators[a], counts[c], max_ops, budget) != 0) break;
+        }
+    }
+    return 0;
+}
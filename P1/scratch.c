@@ -0,0 +1,104 @@
+/**
+ *
+ * scratch.c: Stack-like scratch allocation with mark/release (see scratch.h)
+ */
+
+#include <stdint.h>
+#include "mymalloc.h"
+#include "scratch.h"
+
+#define SCRATCH_ALIGN 8  // mymalloc's ALIGNMENT
+
+// Blocks are chained newest first. The header is a multiple of
+// SCRATCH_ALIGN, so the first object in a block is aligned like the block.
+struct scratch_block {
+    scratch_block_t *prev;  // Block allocated from before this one
+    size_t size;            // Whole block, header included
+};
+
+_Static_assert(sizeof(scratch_block_t) % SCRATCH_ALIGN == 0, "scratch block header misaligns objects");
+
+void scratch_init(scratch_t *s, size_t block_size) {
+    s->block = NULL;
+    s->top = 0;
+    s->block_size = block_size != 0 ? block_size : SCRATCH_BLOCK;
+    s->spare = NULL;
+}
+
+// Chain a block with room for need bytes after its header, reusing the
+// spare if it is large enough. Returns 0, or -1 if the heap is full.
+static int push_block(scratch_t *s, size_t need) {
+    scratch_block_t *block;
+    size_t size = sizeof(scratch_block_t) + need;
+
+    if (size < s->block_size) {
+        size = s->block_size;
+    }
+    if (s->spare != NULL && s->spare->size >= size) {
+        block = s->spare;
+        s->spare = NULL;
+    } else {
+        block = malloc(size);
+        if (block == NULL) {
+            return -1;
+        }
+        block->size = size;
+    }
+    block->prev = s->block;
+    s->block = block;
+    s->top = sizeof(scratch_block_t);
+    return 0;
+}
+
+// Unchain the current block, keeping it as the spare if it is an ordinary
+// one and there is none yet
+static void pop_block(scratch_t *s) {
+    scratch_block_t *block = s->block;
+
+    s->block = block->prev;
+    s->top = s->block != NULL ? s->block->size : 0;
+    if (s->spare == NULL && block->size == s->block_size) {
+        s->spare = block;
+    } else {
+        free(block);
+    }
+}
+
+void *scratch_alloc(scratch_t *s, size_t size) {
+    if (size == 0 || size > SIZE_MAX - sizeof(scratch_block_t) - SCRATCH_ALIGN) {
+        return NULL;
+    }
+    size_t aligned_size = (size + SCRATCH_ALIGN - 1) & ~(size_t)(SCRATCH_ALIGN - 1);
+
+    if (s->block == NULL || aligned_size > s->block->size - s->top) {
+        if (push_block(s, aligned_size) != 0) {
+            return NULL;
+        }
+    }
+    void *object = (char *)s->block + s->top;
+    s->top += aligned_size;
+    return object;
+}
+
+scratch_mark_t scratch_mark(const scratch_t *s) {
+    scratch_mark_t mark = { s->block, s->top };
+    return mark;
+}
+
+void scratch_release_to_mark(scratch_t *s, scratch_mark_t mark) {
+    // Only blocks chained since the mark are touched, never the objects
+    while (s->block != mark.block) {
+        pop_block(s);
+    }
+    s->top = mark.top;
+}
+
+void scratch_destroy(scratch_t *s) {
+    while (s->block != NULL) {
+        pop_block(s);
+    }
+    if (s->spare != NULL) {
+        free(s->spare);
+    }
+    scratch_init(s, s->block_size);
+}
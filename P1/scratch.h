@@ -0,0 +1,66 @@
+/**
+ *
+ * scratch.h: Stack-like scratch allocation with mark/release
+ *
+ * For temporaries allocated in nested scopes and dropped in reverse order.
+ * A scratch_t hands out memory by bumping a pointer through a block taken
+ * from the mymalloc heap; when the block is full it chains another one.
+ * scratch_mark() records the current position and scratch_release_to_mark()
+ * returns to it, dropping everything allocated since in one step: objects
+ * are never passed to myfree() individually, only the overflow blocks that
+ * the release empties. The most recently emptied block is kept as a spare,
+ * so a scope that repeatedly crosses a block boundary does not go back to
+ * the heap each time.
+ *
+ *   scratch_t s;
+ *   scratch_init(&s, 0);
+ *   scratch_mark_t m = scratch_mark(&s);
+ *   char *tmp = scratch_alloc(&s, 100);
+ *   ...
+ *   scratch_release_to_mark(&s, m);
+ *   scratch_destroy(&s);
+ *
+ * Marks must be released innermost first; releasing to a mark taken after
+ * an earlier release, or to one from another scratch_t, is undefined. A
+ * scratch_t is not thread-safe, like the heap under it.
+ */
+
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include <stddef.h>
+
+#define SCRATCH_BLOCK 1024  // Default block size, header included
+
+typedef struct scratch_block scratch_block_t;
+
+typedef struct scratch {
+    scratch_block_t *block;  // Block being allocated from, NULL before the first
+    size_t top;              // Offset of the next free byte in block
+    size_t block_size;       // Size of the blocks requested from the heap
+    scratch_block_t *spare;  // Emptied block kept for reuse, or NULL
+} scratch_t;
+
+typedef struct scratch_mark {
+    scratch_block_t *block;
+    size_t top;
+} scratch_mark_t;
+
+// Prepare an empty scratch_t drawing blocks of block_size bytes (0 for
+// SCRATCH_BLOCK). Nothing is taken from the heap until the first allocation.
+void scratch_init(scratch_t *s, size_t block_size);
+
+// Allocate size bytes, aligned like mymalloc(). Requests larger than a block
+// get a block of their own. Returns NULL if the heap is out of memory.
+void *scratch_alloc(scratch_t *s, size_t size);
+
+// The current position, to pass to scratch_release_to_mark()
+scratch_mark_t scratch_mark(const scratch_t *s);
+
+// Drop everything allocated since mark was taken
+void scratch_release_to_mark(scratch_t *s, scratch_mark_t mark);
+
+// Return every block, including the spare, to the heap
+void scratch_destroy(scratch_t *s);
+
+#endif
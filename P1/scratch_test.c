@@ -0,0 +1,134 @@
+/**
+ *
+ * scratch_test.c: Tests for the scratch mark/release allocator (scratch.h)
+ *
+ * Checks that nested scopes release in reverse order and reuse the same
+ * memory, that a scope overflowing its block chains more blocks and gets
+ * them back on release, and that releasing never frees objects one by one:
+ * the heap counters only move by whole blocks. Each test prints PASSED or
+ * FAILED; the program exits with status 1 if any test failed.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "mymalloc.h"
+#include "scratch.h"
+
+#define BLOCK 256
+
+static int failures = 0;
+
+static void report(const char *test, int ok) {
+    printf("%s test %s\n", test, ok ? "PASSED" : "FAILED");
+    if (!ok) failures++;
+}
+
+static void test_nested_scopes(void) {
+    scratch_t s;
+    mymalloc_stats_t before, after;
+
+    scratch_init(&s, BLOCK);
+    scratch_mark_t outer = scratch_mark(&s);
+    char *a = scratch_alloc(&s, 10);
+    mymalloc_get_stats(&before);
+
+    scratch_mark_t inner = scratch_mark(&s);
+    char *b = scratch_alloc(&s, 20);
+    char *c = scratch_alloc(&s, 30);
+    scratch_release_to_mark(&s, inner);
+    char *b2 = scratch_alloc(&s, 20);
+    mymalloc_get_stats(&after);
+
+    int ok = a != NULL && b != NULL && c != NULL
+        && b == a + 16 && c == b + 24 && b2 == b
+        && (uintptr_t)a % 8 == 0
+        && after.mallocs == before.mallocs && after.frees == before.frees;
+
+    scratch_release_to_mark(&s, outer);
+    ok = ok && scratch_alloc(&s, 10) == a;
+    scratch_destroy(&s);
+    report("Nested scopes", ok && mymalloc_check() == 0);
+}
+
+static void test_overflow(void) {
+    scratch_t s;
+    mymalloc_stats_t start, full, released;
+    char *objects[40];
+    int ok = 1;
+
+    mymalloc_get_stats(&start);
+    scratch_init(&s, BLOCK);
+    scratch_mark_t mark = scratch_mark(&s);
+    for (int i = 0; i < 40; i++) {
+        objects[i] = scratch_alloc(&s, 24);
+        ok = ok && objects[i] != NULL;
+        if (objects[i] != NULL) memset(objects[i], i, 24);
+    }
+    mymalloc_get_stats(&full);
+    for (int i = 0; i < 40 && ok; i++) {
+        for (int j = 0; j < 24; j++) {
+            ok = ok && objects[i][j] == (char)i;
+        }
+    }
+
+    // 40 * 24 bytes in 256-byte blocks with a 16-byte header: 4 blocks,
+    // one of which is kept as the spare after the release
+    size_t blocks = full.mallocs - start.mallocs;
+    scratch_release_to_mark(&s, mark);
+    mymalloc_get_stats(&released);
+    ok = ok && blocks == 4
+        && released.frees - full.frees == blocks - 1
+        && released.requested - start.requested == BLOCK;
+
+    // The next overflow takes the spare instead of going to the heap
+    scratch_alloc(&s, 24);
+    mymalloc_get_stats(&full);
+    ok = ok && full.mallocs == released.mallocs;
+
+    scratch_destroy(&s);
+    mymalloc_get_stats(&released);
+    ok = ok && released.requested == start.requested;
+    report("Overflow chaining", ok && mymalloc_check() == 0);
+}
+
+static void test_large_objects(void) {
+    scratch_t s;
+    mymalloc_stats_t start, after;
+
+    mymalloc_get_stats(&start);
+    scratch_init(&s, BLOCK);
+    scratch_mark_t mark = scratch_mark(&s);
+    char *small = scratch_alloc(&s, 8);
+    char *large = scratch_alloc(&s, 3 * BLOCK);
+    char *next = scratch_alloc(&s, 8);
+    int ok = small != NULL && large != NULL && next != NULL;
+    if (ok) memset(large, 1, 3 * BLOCK);
+
+    // A request the heap cannot satisfy fails without disturbing the scratch
+    ok = ok && scratch_alloc(&s, 1 << 30) == NULL
+        && scratch_alloc(&s, 0) == NULL
+        && scratch_alloc(&s, 8) == next + 8;
+
+    // The oversized block is not kept as the spare
+    scratch_release_to_mark(&s, mark);
+    mymalloc_get_stats(&after);
+    ok = ok && after.requested - start.requested == BLOCK;
+    scratch_destroy(&s);
+    mymalloc_get_stats(&after);
+    ok = ok && after.requested == start.requested;
+    report("Large objects", ok && mymalloc_check() == 0);
+}
+
+int main(void) {
+    test_nested_scopes();
+    test_overflow();
+    test_large_objects();
+
+    if (failures > 0) {
+        printf("%d scratch tests FAILED\n", failures);
+        return 1;
+    }
+    printf("All scratch tests passed\n");
+    return 0;
+}
@@ -0,0 +1,22 @@
+/**
+ *
+ * shim.c: Plain malloc/free entry points for loading mymalloc with dlopen()
+ *
+ * Built into libmymalloc.so so that memgrind's dlopen backend can load this
+ * allocator the same way it loads jemalloc or tcmalloc:
+ *
+ *   ./memgrind -a system,dlopen:./libmymalloc.so:shim_malloc,shim_free
+ */
+
+#include <stdlib.h>
+
+#define MYMALLOC_NO_MACROS
+#include "mymalloc.h"
+
+void *shim_malloc(size_t size) {
+    return mymalloc(size, MM_SITE());
+}
+
+void shim_free(void *ptr) {
+    myfree(ptr, MM_SITE());
+}
@@ -0,0 +1,115 @@
+/**
+ *
+ * shutdown_test.c: Tests for the fast shutdown mode (mymalloc_shutdown)
+ *
+ * Checks that frees after a shutdown are still counted and validated when a
+ * leak check is to follow, that they leave the heap consistent without
+ * merging with the chunk before, and that with the leak check off myfree()
+ * neither counts nor releases anything. The program then leaks three
+ * objects and shuts down with a sampled leak check, which run_tests.sh
+ * expects to find on stderr. Run with MYMALLOC_LEAK_CHECK=full, shutdown is
+ * ignored and the full report is written instead. Each test prints PASSED or
+ * FAILED; the program exits with status 1 if any test failed.
+ *
+ * "./shutdown_test bad_free" frees a bad pointer with the leak check off;
+ * it must still be rejected, with exit status 2.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mymalloc.h"
+
+static int failures = 0;
+static int forced_full = 0;
+
+static void report(const char *test, int ok) {
+    printf("%s test %s\n", test, ok ? "PASSED" : "FAILED");
+    if (!ok) failures++;
+}
+
+static void test_lazy_free(void) {
+    mymalloc_stats_t before, after;
+
+    mymalloc_reset();
+    char *a = malloc(64);
+    char *b = malloc(64);
+    char *c = malloc(64);
+    mymalloc_get_stats(&before);
+
+    mymalloc_shutdown(MYMALLOC_LEAKS_FULL);
+    free(b);
+    free(a);
+    free(c);
+    mymalloc_get_stats(&after);
+
+    // b and c do not merge back into a, but the memory is free all the same
+    int ok = a != NULL && b != NULL && c != NULL
+        && after.frees - before.frees == 3
+        && after.requested == 0 && after.held == 0;
+    ok = ok && mymalloc_check() == 0;
+
+    char *d = malloc(64);
+    ok = ok && d != NULL;
+    free(d);
+    report("Lazy free", ok && mymalloc_check() == 0);
+}
+
+static void test_no_op_free(void) {
+    mymalloc_stats_t before, after;
+
+    mymalloc_reset();
+    char *a = malloc(64);
+    mymalloc_get_stats(&before);
+
+    mymalloc_shutdown(MYMALLOC_LEAKS_OFF);
+    free(a);
+    mymalloc_get_stats(&after);
+
+    int ok = a != NULL;
+    if (forced_full) {
+        ok = ok && after.frees - before.frees == 1 && after.held == 0;
+    } else {
+        ok = ok && after.frees == before.frees && after.held == before.held;
+        // The chunk stays allocated, so a second free is not a double free
+        free(a);
+    }
+    report("No-op free", ok && mymalloc_check() == 0);
+}
+
+static void free_bad_pointer(void) {
+    char *a = malloc(64);
+    mymalloc_shutdown(MYMALLOC_LEAKS_OFF);
+    free(a + 1);
+    printf("ERROR: Program did not terminate after freeing a bad pointer\n");
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "bad_free") == 0) {
+        free_bad_pointer();
+        return 1;
+    }
+
+    const char *check = getenv("MYMALLOC_LEAK_CHECK");
+    forced_full = check != NULL && strcmp(check, "full") == 0;
+
+    test_lazy_free();
+    test_no_op_free();
+
+    if (failures > 0) {
+        printf("%d shutdown tests FAILED\n", failures);
+        return 1;
+    }
+
+    // Leak three objects at the start of the heap, where the sample looks
+    mymalloc_reset();
+    for (int i = 0; i < 3; i++) {
+        if (malloc(32) == NULL) {
+            printf("Leak setup FAILED\n");
+            return 1;
+        }
+    }
+    mymalloc_shutdown(MYMALLOC_LEAKS_SAMPLE);
+    printf("All shutdown tests passed\n");
+    return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ *
+ * telemetry.h: Layout of the shared-memory stats page mymalloc can export
+ *
+ * When mymalloc.c is built with -DTELEMETRY and the MYMALLOC_TELEMETRY
+ * environment variable names a file (e.g. /dev/shm/mymalloc.1234), the
+ * allocator maps one page of that file and publishes a snapshot into it
+ * every MYMALLOC_TELEMETRY_INTERVAL operations (default 1024) and at exit.
+ * Another process maps the same file read-only and reads it without
+ * stopping the program; telemetry_read.c prints it in the Prometheus text
+ * format. The page holds the usage counters, free-space fragmentation, a
+ * latency histogram for mymalloc() and myfree(), and the call sites holding
+ * the most live bytes.
+ *
+ * The page is protected by a sequence lock: the writer makes seq odd,
+ * updates the page and makes seq even again. A reader copies the page and
+ * retries if seq was odd or changed while it copied (see telemetry_copy).
+ * Without -DTELEMETRY none of this is compiled and the allocator pays
+ * nothing for it.
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define TELEMETRY_MAGIC 0x4c544d4d  // "MMTL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_PAGE_SIZE 4096
+#define TELEMETRY_TOP_SITES 8
+#define TELEMETRY_LATENCY_BUCKETS 32  // Bucket i counts operations of 2^i to 2^(i+1) - 1 ns;
+                                      // the last counts everything from 2^31 ns up
+
+typedef struct telemetry_latency {
+    uint64_t total_ns;
+    uint64_t buckets[TELEMETRY_LATENCY_BUCKETS];
+} telemetry_latency_t;
+
+typedef struct telemetry_site {
+    char file[48];
+    uint32_t line;
+    uint32_t objects;        // Live objects allocated here
+    uint64_t bytes;          // Their payload bytes
+} telemetry_site_t;
+
+typedef struct telemetry_page {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t seq;            // Odd while the writer is updating the page
+    uint32_t pid;
+    uint64_t snapshots;      // Snapshots published so far
+
+    // Counters, as from mymalloc_get_stats()
+    uint64_t heap_size;
+    uint64_t requested;
+    uint64_t held;
+    uint64_t peak_requested;
+    uint64_t peak_held;
+    uint64_t mallocs;
+    uint64_t frees;
+    uint64_t failed;
+
+    // Free space, from a heap walk: fragmentation is 1 - largest_free / free_bytes
+    uint64_t free_bytes;
+    uint64_t free_chunks;
+    uint64_t largest_free;
+
+    // Latency of mymalloc()/myfree() calls since the page was created
+    telemetry_latency_t malloc_latency;
+    telemetry_latency_t free_latency;
+
+    // Sites holding the most live bytes, largest first
+    uint32_t nsites;
+    uint32_t unused;
+    telemetry_site_t top_sites[TELEMETRY_TOP_SITES];
+} telemetry_page_t;
+
+_Static_assert(sizeof(telemetry_page_t) <= TELEMETRY_PAGE_SIZE, "telemetry page overflows");
+
+// Copy a consistent snapshot of a live page. Returns 0 on success, -1 if the
+// page is not a telemetry page or the writer never left it consistent.
+static inline int telemetry_copy(const telemetry_page_t *page, telemetry_page_t *out) {
+    for (int attempt = 0; attempt < 1000; attempt++) {
+        uint32_t before = __atomic_load_n(&page->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            continue;
+        }
+        memcpy(out, (const void *)page, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&page->seq, __ATOMIC_RELAXED) == before) {
+            return out->magic == TELEMETRY_MAGIC && out->version == TELEMETRY_VERSION ? 0 : -1;
+        }
+    }
+    return -1;
+}
+
+#endif
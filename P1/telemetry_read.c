@@ -0,0 +1,127 @@
+/**
+ *
+ * telemetry_read.c: Print a running program's mymalloc telemetry page
+ *
+ * Maps the page a program built with -DTELEMETRY publishes (see
+ * telemetry.h) and prints it in the Prometheus text exposition format, so
+ * the output can be served by any exporter that relays text files:
+ *
+ *   make clean && make TELEMETRY=1
+ *   MYMALLOC_TELEMETRY=/dev/shm/mymalloc.page ./memgrind -w all -n 1000000 &
+ *   ./telemetry_read -i 1 /dev/shm/mymalloc.page
+ *
+ * The reader never writes to the page and never blocks the program.
+ *
+ * Usage: ./telemetry_read [-i SECONDS] FILE
+ *
+ *   -i SECONDS  print a snapshot every SECONDS seconds until interrupted
+ *               (default: print one and exit)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "telemetry.h"
+
+static void print_histogram(const char *name, const telemetry_latency_t *latency) {
+    uint64_t count = 0;
+
+    printf("# TYPE %s histogram\n", name);
+    for (int i = 0; i < TELEMETRY_LATENCY_BUCKETS - 1; i++) {
+        count += latency->buckets[i];
+        // Bucket i holds latencies below 2^(i+1) ns
+        printf("%s_bucket{le=\"%.12g\"} %llu\n", name, (double)(2UL << i) / 1e9,
+               (unsigned long long)count);
+    }
+    // The last bucket also holds everything clamped into it, so it has no
+    // finite upper bound
+    count += latency->buckets[TELEMETRY_LATENCY_BUCKETS - 1];
+    printf("%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)count);
+    printf("%s_sum %.9f\n", name, latency->total_ns / 1e9);
+    printf("%s_count %llu\n", name, (unsigned long long)count);
+}
+
+static void print_metric(const char *name, const char *type, uint64_t value) {
+    printf("# TYPE %s %s\n%s %llu\n", name, type, name, (unsigned long long)value);
+}
+
+static void print_page(const telemetry_page_t *p) {
+    print_metric("mymalloc_heap_bytes", "gauge", p->heap_size);
+    print_metric("mymalloc_requested_bytes", "gauge", p->requested);
+    print_metric("mymalloc_held_bytes", "gauge", p->held);
+    print_metric("mymalloc_peak_requested_bytes", "gauge", p->peak_requested);
+    print_metric("mymalloc_peak_held_bytes", "gauge", p->peak_held);
+    print_metric("mymalloc_mallocs_total", "counter", p->mallocs);
+    print_metric("mymalloc_frees_total", "counter", p->frees);
+    print_metric("mymalloc_failed_total", "counter", p->failed);
+    print_metric("mymalloc_free_bytes", "gauge", p->free_bytes);
+    print_metric("mymalloc_free_chunks", "gauge", p->free_chunks);
+    print_metric("mymalloc_largest_free_bytes", "gauge", p->largest_free);
+    printf("# TYPE mymalloc_fragmentation_ratio gauge\nmymalloc_fragmentation_ratio %.4f\n",
+           p->free_bytes == 0 ? 0.0 : 1.0 - (double)p->largest_free / p->free_bytes);
+
+    print_histogram("mymalloc_malloc_latency_seconds", &p->malloc_latency);
+    print_histogram("mymalloc_free_latency_seconds", &p->free_latency);
+
+    printf("# TYPE mymalloc_site_live_bytes gauge\n");
+    for (uint32_t i = 0; i < p->nsites && i < TELEMETRY_TOP_SITES; i++) {
+        printf("mymalloc_site_live_bytes{site=\"%.*s:%u\"} %llu\n",
+               (int)sizeof(p->top_sites[i].file), p->top_sites[i].file, p->top_sites[i].line,
+               (unsigned long long)p->top_sites[i].bytes);
+    }
+    printf("# TYPE mymalloc_site_live_objects gauge\n");
+    for (uint32_t i = 0; i < p->nsites && i < TELEMETRY_TOP_SITES; i++) {
+        printf("mymalloc_site_live_objects{site=\"%.*s:%u\"} %u\n",
+               (int)sizeof(p->top_sites[i].file), p->top_sites[i].file, p->top_sites[i].line,
+               p->top_sites[i].objects);
+    }
+    printf("# pid %u, snapshot %llu\n", p->pid, (unsigned long long)p->snapshots);
+}
+
+int main(int argc, char *argv[]) {
+    double interval = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:")) != -1) {
+        switch (opt) {
+        case 'i':
+            interval = atof(optarg);
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-i SECONDS] FILE\n", argv[0]);
+            return 1;
+        }
+    }
+    if (optind != argc - 1) {
+        fprintf(stderr, "Usage: %s [-i SECONDS] FILE\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(argv[optind], O_RDONLY);
+    if (fd < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+    const telemetry_page_t *page = mmap(NULL, TELEMETRY_PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (page == MAP_FAILED) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    do {
+        telemetry_page_t snapshot;
+        if (telemetry_copy(page, &snapshot) != 0) {
+            fprintf(stderr, "telemetry_read: %s is not a mymalloc telemetry page\n", argv[optind]);
+            return 1;
+        }
+        print_page(&snapshot);
+        fflush(stdout);
+        if (interval > 0) {
+            usleep((useconds_t)(interval * 1e6));
+        }
+    } while (interval > 0);
+    return 0;
+}
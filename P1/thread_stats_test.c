@@ -0,0 +1,178 @@
+/**
+ *
+ * thread_stats_test.c: Tests for the per-thread usage counters
+ *
+ * mymalloc keeps its operation counts in one block per thread and merges
+ * them in mymalloc_get_stats(). The heap itself is not thread-safe, so the
+ * threads here take turns under a mutex; what is tested is that counts made
+ * on different threads, including objects freed by a thread other than the
+ * one that allocated them, add up to the same totals a single thread would
+ * see. The peaks must stay exact when one thread allocates what another
+ * frees, and the counts of exited threads, more of them than there are
+ * blocks, must not be lost.
+ * Each test prints PASSED or FAILED; the program exits with status 1 if any
+ * test failed.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include "mymalloc.h"
+
+#define THREADS 8
+#define OBJECTS 8
+#define OBJECT_SIZE 24
+#define HANDOFFS 1000
+#define SHORT_THREADS 200  // More than the 64 stats blocks
+
+static pthread_mutex_t heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_barrier_t handoff;
+static void *objects[THREADS][OBJECTS];
+static void *handed;
+static int failures = 0;
+
+static void report(const char *test, int ok) {
+    printf("%s test %s\n", test, ok ? "PASSED" : "FAILED");
+    if (!ok) failures++;
+}
+
+// Allocate OBJECTS objects, freeing every other one on the same thread
+static void *allocate_objects(void *arg) {
+    void **mine = arg;
+    for (int i = 0; i < OBJECTS; i++) {
+        pthread_mutex_lock(&heap_lock);
+        mine[i] = malloc(OBJECT_SIZE);
+        pthread_mutex_unlock(&heap_lock);
+    }
+    for (int i = 0; i < OBJECTS; i += 2) {
+        pthread_mutex_lock(&heap_lock);
+        free(mine[i]);
+        mine[i] = NULL;
+        pthread_mutex_unlock(&heap_lock);
+    }
+    return NULL;
+}
+
+static void test_merged_counts(void) {
+    pthread_t threads[THREADS];
+    mymalloc_stats_t stats;
+
+    for (int t = 0; t < THREADS; t++) {
+        pthread_create(&threads[t], NULL, allocate_objects, objects[t]);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    mymalloc_get_stats(&stats);
+    int live = THREADS * OBJECTS / 2;
+    int ok = stats.mallocs == THREADS * OBJECTS
+        && stats.frees == (size_t)(THREADS * OBJECTS - live)
+        && stats.requested == (size_t)live * OBJECT_SIZE
+        && stats.peak_requested >= stats.requested
+        && stats.peak_held >= stats.held;
+    report("Merged counts", ok && mymalloc_check() == 0);
+}
+
+// The main thread frees what the workers left, so only its free count
+// exceeds its malloc count, while the shared byte totals return to zero
+static void test_cross_thread_free(void) {
+    mymalloc_stats_t stats;
+
+    for (int t = 0; t < THREADS; t++) {
+        for (int i = 0; i < OBJECTS; i++) {
+            free(objects[t][i]);
+        }
+    }
+
+    mymalloc_get_stats(&stats);
+    int ok = stats.requested == 0 && stats.held == 0
+        && stats.frees == stats.mallocs;
+    report("Cross-thread free", ok && mymalloc_check() == 0);
+}
+
+static void test_reset_peak(void) {
+    mymalloc_stats_t stats;
+
+    mymalloc_reset_peak();
+    mymalloc_get_stats(&stats);
+    int ok = stats.peak_requested == 0 && stats.peak_held == 0;
+
+    void *p = malloc(100);
+    mymalloc_get_stats(&stats);
+    ok = ok && stats.peak_requested == 100 && stats.peak_held == stats.held;
+    free(p);
+    report("Reset peak", ok);
+}
+
+// Allocate HANDOFFS objects one at a time, for the main thread to free
+static void *allocate_for_main(void *arg) {
+    for (int i = 0; i < HANDOFFS; i++) {
+        handed = malloc(100);
+        pthread_barrier_wait(&handoff);
+        pthread_barrier_wait(&handoff);
+    }
+    return NULL;
+}
+
+// One object is live at a time, so the peak is one object's worth even
+// though the allocating thread's counts only ever grow
+static void test_handoff_peak(void) {
+    pthread_t thread;
+    mymalloc_stats_t stats;
+    size_t one_held = 0;
+
+    mymalloc_reset_peak();
+    pthread_barrier_init(&handoff, NULL, 2);
+    pthread_create(&thread, NULL, allocate_for_main, NULL);
+    for (int i = 0; i < HANDOFFS; i++) {
+        pthread_barrier_wait(&handoff);
+        if (i == 0) {
+            mymalloc_get_stats(&stats);
+            one_held = stats.held;
+        }
+        free(handed);
+        pthread_barrier_wait(&handoff);
+    }
+    pthread_join(thread, NULL);
+    pthread_barrier_destroy(&handoff);
+
+    mymalloc_get_stats(&stats);
+    int ok = one_held > 100 && stats.peak_held == one_held
+        && stats.peak_requested == 100 && stats.held == 0;
+    report("Handoff peak", ok && mymalloc_check() == 0);
+}
+
+static void *allocate_once(void *arg) {
+    free(malloc(OBJECT_SIZE));
+    return NULL;
+}
+
+static void test_exited_threads(void) {
+    mymalloc_stats_t before, after;
+
+    mymalloc_get_stats(&before);
+    for (int t = 0; t < SHORT_THREADS; t++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, allocate_once, NULL);
+        pthread_join(thread, NULL);
+    }
+    mymalloc_get_stats(&after);
+    int ok = after.mallocs - before.mallocs == SHORT_THREADS
+        && after.frees - before.frees == SHORT_THREADS && after.held == 0;
+    report("Exited threads", ok && mymalloc_check() == 0);
+}
+
+int main(void) {
+    test_merged_counts();
+    test_cross_thread_free();
+    test_reset_peak();
+    test_handoff_peak();
+    test_exited_threads();
+
+    if (failures > 0) {
+        printf("%d thread stats tests FAILED\n", failures);
+        return 1;
+    }
+    printf("All thread stats tests passed\n");
+    return 0;
+}
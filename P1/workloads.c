@@ -0,0 +1,513 @@
+/**
+ *
+ * workloads.c: Allocation workloads shared by memgrind and the benchmarks
+ *
+ * The first five workloads are the original memgrind tests, generalised so
+ * the batch size and number of operations can be changed. The rest model
+ * allocation patterns seen in real programs:
+ *
+ * - powerlaw: random alloc/free with power-law object sizes (most objects
+ *   small, a long tail of large ones)
+ * - larson:   a pool of live objects where random slots are replaced, so
+ *   lifetimes are random (after the larson server benchmark)
+ * - cfrac:    a long-lived core plus a stream of short-lived temporaries freed
+ *   in near-LIFO order (after the cfrac factoring benchmark)
+ * - vector:   a growing and shrinking array that reallocates on every
+ *   capacity change
+ * - intern:   a string interning table that is filled and then dropped
+ * - tree:     build a binary search tree of random keys, then tear it down
+ * - lru:      an LRU cache with a skewed key distribution and evictions
+ *
+ * Every workload counts one operation per malloc() or free() call, and
+ * allocates through the allocator_t it is given (see allocators.h). intern
+ * and lru also count each lookup that hits, since with skewed keys most of
+ * them do and the ops budget would otherwise not bound the run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "workloads.h"
+
+// The allocator under test; bookkeeping (slot tables, hash buckets) comes
+// from the system allocator so it does not compete for the measured heap.
+static const allocator_t *allocator;
+
+static void *table_alloc(size_t count, size_t size) {
+    void *table = calloc(count, size);
+    if (table == NULL) {
+        fprintf(stderr, "workloads: unable to allocate bookkeeping table\n");
+        exit(1);
+    }
+    return table;
+}
+
+static void table_free(void *table) {
+    free(table);
+}
+
+// xorshift64* so a given seed always produces the same operation sequence
+static unsigned long long rng_state = 1;
+
+static void seed_rand(unsigned long seed) {
+    rng_state = seed ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+static unsigned long next_rand(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (unsigned long)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+// Uniform value in [lo, hi]
+static size_t rand_range(size_t lo, size_t hi) {
+    return lo + next_rand() % (hi - lo + 1);
+}
+
+// Power-law size in [1, max]: pick a power of two with probability halving
+// at every step, then a uniform size inside that octave. The density falls
+// off roughly as 1/size^2, like object sizes in most C programs.
+static size_t powerlaw_size(size_t max) {
+    size_t octave = 1;
+    while (octave * 2 <= max && (next_rand() & 1)) {
+        octave *= 2;
+    }
+    size_t hi = octave * 2 - 1;
+    if (hi > max) hi = max;
+    return rand_range(octave, hi);
+}
+
+// malloc() that records failures instead of letting the workload crash
+static void *try_malloc(size_t size, workload_result_t *result) {
+    void *ptr = allocator->malloc(size);
+    result->ops++;
+    if (ptr == NULL) {
+        result->failed++;
+    }
+    return ptr;
+}
+
+static void try_free(void *ptr, workload_result_t *result) {
+    if (ptr == NULL) return;
+    allocator->free(ptr);
+    result->ops++;
+}
+
+// Workload 1: Malloc/free 1 byte, ops/2 times
+static void workload_seq(const workload_params_t *p, workload_result_t *r) {
+    while (r->ops < p->ops) {
+        void *ptr = try_malloc(1, r);
+        try_free(ptr, r);
+    }
+}
+
+// Workload 2: Malloc `size` 1-byte chunks, then free all; repeat
+static void workload_batch(const workload_params_t *p, workload_result_t *r) {
+    void **ptrs = table_alloc(p->size, sizeof(void *));
+    while (r->ops < p->ops) {
+        for (long i = 0; i < p->size; i++) {
+            ptrs[i] = try_malloc(1, r);
+        }
+        for (long i = 0; i < p->size; i++) {
+            try_free(ptrs[i], r);
+        }
+    }
+    table_free(ptrs);
+}
+
+// Workload 3: Random malloc/free until `size` allocations; repeat
+static void workload_random(const workload_params_t *p, workload_result_t *r) {
+    void **ptrs = table_alloc(p->size, sizeof(void *));
+    while (r->ops < p->ops) {
+        long allocated = 0;
+        long inUse = 0;
+
+        while (allocated < p->size) {
+            if (inUse == 0 || next_rand() % 2 == 0) {
+                ptrs[inUse++] = try_malloc(1, r);
+                allocated++;
+            } else {
+                long index = next_rand() % inUse;
+                try_free(ptrs[index], r);
+                ptrs[index] = ptrs[--inUse];
+            }
+        }
+        while (inUse > 0) {
+            try_free(ptrs[--inUse], r);
+        }
+    }
+    table_free(ptrs);
+}
+
+// Workload 4: Create/destroy a linked list of `size` nodes; repeat
+typedef struct node {
+    int data;
+    struct node *next;
+} Node;
+
+static void workload_list(const workload_params_t *p, workload_result_t *r) {
+    while (r->ops < p->ops) {
+        Node *head = NULL;
+        for (long i = 0; i < p->size; i++) {
+            Node *newNode = try_malloc(sizeof(Node), r);
+            if (newNode == NULL) continue;
+            newNode->data = i;
+            newNode->next = head;
+            head = newNode;
+        }
+        while (head != NULL) {
+            Node *temp = head;
+            head = head->next;
+            try_free(temp, r);
+        }
+    }
+}
+
+// Workload 5: Allocate and free a `size` x 8 2D array of ints; repeat
+static void workload_matrix(const workload_params_t *p, workload_result_t *r) {
+    const int cols = 8;
+    while (r->ops < p->ops) {
+        int **matrix = try_malloc(p->size * sizeof(int *), r);
+        if (matrix == NULL) continue;
+        for (long i = 0; i < p->size; i++) {
+            matrix[i] = try_malloc(cols * sizeof(int), r);
+            if (matrix[i] == NULL) continue;
+            for (int j = 0; j < cols; j++) {
+                matrix[i][j] = i * cols + j;
+            }
+        }
+        for (long i = 0; i < p->size; i++) {
+            try_free(matrix[i], r);
+        }
+        try_free(matrix, r);
+    }
+}
+
+// Power-law sizes: each op picks a random slot and frees it if occupied,
+// otherwise fills it with an object of power-law size (1 to 128 bytes)
+static void workload_powerlaw(const workload_params_t *p, workload_result_t *r) {
+    void **slots = table_alloc(p->size, sizeof(void *));
+    while (r->ops < p->ops) {
+        long i = next_rand() % p->size;
+        if (slots[i] != NULL) {
+            try_free(slots[i], r);
+            slots[i] = NULL;
+        } else {
+            slots[i] = try_malloc(powerlaw_size(128), r);
+        }
+    }
+    for (long i = 0; i < p->size; i++) {
+        try_free(slots[i], r);
+    }
+    table_free(slots);
+}
+
+// Larson: fill `size` slots, then repeatedly replace a random slot with a
+// new object of 8 to 64 bytes. Lifetimes are geometric, so there is a mix
+// of objects that die at once and objects that live for the whole run.
+static void workload_larson(const workload_params_t *p, workload_result_t *r) {
+    void **slots = table_alloc(p->size, sizeof(void *));
+    for (long i = 0; i < p->size && r->ops < p->ops; i++) {
+        slots[i] = try_malloc(rand_range(8, 64), r);
+    }
+    while (r->ops < p->ops) {
+        long i = next_rand() % p->size;
+        try_free(slots[i], r);
+        slots[i] = try_malloc(rand_range(8, 64), r);
+    }
+    for (long i = 0; i < p->size; i++) {
+        try_free(slots[i], r);
+    }
+    table_free(slots);
+}
+
+// cfrac: `size`/4 long-lived objects held for the whole run, plus a stack
+// of up to 8 short-lived temporaries (4 to 32 bytes) pushed and popped at
+// random, so most frees release the most recent allocation
+static void workload_cfrac(const workload_params_t *p, workload_result_t *r) {
+    long core_count = p->size / 4 > 0 ? p->size / 4 : 1;
+    void **core = table_alloc(core_count, sizeof(void *));
+    void *temps[8];
+    int depth = 0;
+
+    for (long i = 0; i < core_count && r->ops < p->ops; i++) {
+        core[i] = try_malloc(rand_range(16, 48), r);
+    }
+    while (r->ops < p->ops) {
+        if (depth == 0 || (depth < 8 && next_rand() % 3 != 0)) {
+            temps[depth++] = try_malloc(rand_range(4, 32), r);
+        } else {
+            try_free(temps[--depth], r);
+        }
+    }
+    while (depth > 0) {
+        try_free(temps[--depth], r);
+    }
+    for (long i = 0; i < core_count; i++) {
+        try_free(core[i], r);
+    }
+    table_free(core);
+}
+
+// Vector: push ints until `size` elements, then pop back to empty. The
+// backing array doubles when full and halves when a quarter full, copying
+// the contents every time, like a typical dynamic array.
+static void workload_vector(const workload_params_t *p, workload_result_t *r) {
+    int *data = NULL;
+    long length = 0;
+    long capacity = 0;
+    int growing = 1;
+
+    while (r->ops < p->ops) {
+        long new_capacity = capacity;
+        if (growing && length == capacity) {
+            new_capacity = capacity ? capacity * 2 : 2;
+        } else if (!growing && capacity > 2 && length <= capacity / 4) {
+            new_capacity = capacity / 2;
+        }
+
+        if (new_capacity != capacity) {
+            int *grown = try_malloc(new_capacity * sizeof(int), r);
+            if (grown == NULL) {
+                // Out of room: start shrinking early
+                growing = 0;
+                continue;
+            }
+            if (data != NULL) {
+                memcpy(grown, data, length * sizeof(int));
+                try_free(data, r);
+            }
+            data = grown;
+            capacity = new_capacity;
+        }
+
+        if (growing) {
+            data[length] = length;
+            length++;
+            if (length >= p->size) growing = 0;
+        } else if (length > 0) {
+            length--;
+        } else {
+            try_free(data, r);
+            data = NULL;
+            capacity = 0;
+            growing = 1;
+        }
+    }
+    try_free(data, r);
+}
+
+// String interning: look up random identifiers in a hash table, copying
+// the string into the heap the first time it is seen. Once `size` strings
+// are interned the whole table is dropped, like a per-request symbol table.
+typedef struct intern_entry {
+    struct intern_entry *next;
+    char text[];
+} InternEntry;
+
+static void intern_clear(InternEntry **buckets, long nbuckets, workload_result_t *r) {
+    for (long b = 0; b < nbuckets; b++) {
+        while (buckets[b] != NULL) {
+            InternEntry *entry = buckets[b];
+            buckets[b] = entry->next;
+            try_free(entry, r);
+        }
+    }
+}
+
+static void workload_intern(const workload_params_t *p, workload_result_t *r) {
+    long nbuckets = p->size;
+    InternEntry **buckets = table_alloc(nbuckets, sizeof(InternEntry *));
+    long interned = 0;
+    char name[32];
+
+    while (r->ops < p->ops) {
+        unsigned long id = powerlaw_size(p->size * 2);
+        int len = snprintf(name, sizeof(name), "sym_%lu", id);
+        InternEntry **bucket = &buckets[id % nbuckets];
+        InternEntry *entry = *bucket;
+
+        while (entry != NULL && strcmp(entry->text, name) != 0) {
+            entry = entry->next;
+        }
+        if (entry != NULL) {
+            r->ops++;
+        } else {
+            entry = try_malloc(sizeof(InternEntry) + len + 1, r);
+            if (entry != NULL) {
+                memcpy(entry->text, name, len + 1);
+                entry->next = *bucket;
+                *bucket = entry;
+                interned++;
+            }
+        }
+        if (interned >= p->size || entry == NULL) {
+            intern_clear(buckets, nbuckets, r);
+            interned = 0;
+        }
+    }
+    intern_clear(buckets, nbuckets, r);
+    table_free(buckets);
+}
+
+// Tree: insert `size` random keys into an unbalanced binary search tree,
+// then free it bottom-up; repeat
+typedef struct tree_node {
+    unsigned long key;
+    struct tree_node *left;
+    struct tree_node *right;
+} TreeNode;
+
+static void tree_free(TreeNode *node, workload_result_t *r) {
+    // Iterative post-order teardown: rotate left children up so the tree
+    // becomes a right spine, freeing each node once it has no left child
+    while (node != NULL) {
+        if (node->left != NULL) {
+            TreeNode *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            TreeNode *right = node->right;
+            try_free(node, r);
+            node = right;
+        }
+    }
+}
+
+static void workload_tree(const workload_params_t *p, workload_result_t *r) {
+    while (r->ops < p->ops) {
+        TreeNode *root = NULL;
+        for (long i = 0; i < p->size; i++) {
+            TreeNode *node = try_malloc(sizeof(TreeNode), r);
+            if (node == NULL) continue;
+            node->key = next_rand();
+            node->left = node->right = NULL;
+
+            TreeNode **link = &root;
+            while (*link != NULL) {
+                link = node->key < (*link)->key ? &(*link)->left : &(*link)->right;
+            }
+            *link = node;
+        }
+        tree_free(root, r);
+    }
+}
+
+// LRU cache: `size` entries with values of 8 to 48 bytes. Keys are drawn
+// from a skewed distribution over twice the capacity, so there is a steady
+// mix of hits (move to front) and misses (allocate, evicting the tail).
+typedef struct lru_entry {
+    unsigned long key;
+    struct lru_entry *prev;
+    struct lru_entry *next;
+    void *value;
+} LruEntry;
+
+static void lru_unlink(LruEntry **head, LruEntry **tail, LruEntry *entry) {
+    if (entry->prev) entry->prev->next = entry->next; else *head = entry->next;
+    if (entry->next) entry->next->prev = entry->prev; else *tail = entry->prev;
+}
+
+static void lru_push_front(LruEntry **head, LruEntry **tail, LruEntry *entry) {
+    entry->prev = NULL;
+    entry->next = *head;
+    if (*head) (*head)->prev = entry; else *tail = entry;
+    *head = entry;
+}
+
+static void workload_lru(const workload_params_t *p, workload_result_t *r) {
+    long nkeys = p->size * 2;
+    LruEntry **index = table_alloc(nkeys, sizeof(LruEntry *));
+    LruEntry *head = NULL;
+    LruEntry *tail = NULL;
+    long count = 0;
+
+    while (r->ops < p->ops) {
+        unsigned long key = powerlaw_size(nkeys) - 1;
+        LruEntry *entry = index[key];
+
+        if (entry != NULL) {
+            lru_unlink(&head, &tail, entry);
+            lru_push_front(&head, &tail, entry);
+            r->ops++;
+            continue;
+        }
+
+        if (count >= p->size || (count > 0 && next_rand() % 64 == 0)) {
+            LruEntry *victim = tail;
+            lru_unlink(&head, &tail, victim);
+            index[victim->key] = NULL;
+            try_free(victim->value, r);
+            try_free(victim, r);
+            count--;
+        }
+
+        entry = try_malloc(sizeof(LruEntry), r);
+        if (entry == NULL) continue;
+        entry->key = key;
+        entry->value = try_malloc(rand_range(8, 48), r);
+        if (entry->value == NULL) {
+            try_free(entry, r);
+            continue;
+        }
+        index[key] = entry;
+        lru_push_front(&head, &tail, entry);
+        count++;
+    }
+
+    while (head != NULL) {
+        LruEntry *next = head->next;
+        try_free(head->value, r);
+        try_free(head, r);
+        head = next;
+    }
+    table_free(index);
+}
+
+const workload_t workloads[] = {
+    {"seq",      "Malloc/free in sequence",     240,  120, workload_seq},
+    {"batch",    "Malloc all, then free all",   240,  120, workload_batch},
+    {"random",   "Random malloc/free",          240,  120, workload_random},
+    {"list",     "Linked list",                 240,  120, workload_list},
+    {"matrix",   "Dynamic 2D array",            32,   15,  workload_matrix},
+    {"powerlaw", "Power-law object sizes",      1000, 32,  workload_powerlaw},
+    {"larson",   "Random-lifetime replacement", 1000, 48,  workload_larson},
+    {"cfrac",    "Long-lived core + temporaries", 1000, 64, workload_cfrac},
+    {"vector",   "Growing/shrinking vector",    1000, 256, workload_vector},
+    {"intern",   "String interning",            1000, 48,  workload_intern},
+    {"tree",     "Tree build and teardown",     1000, 64,  workload_tree},
+    {"lru",      "LRU cache churn",             1000, 24,  workload_lru},
+    {NULL, NULL, 0, 0, NULL}
+};
+
+const workload_t *find_workload(const char *name) {
+    char *end;
+    long index = strtol(name, &end, 10);
+    int count = 0;
+
+    while (workloads[count].name != NULL) count++;
+    if (*end == '\0' && index >= 1 && index <= count) {
+        return &workloads[index - 1];
+    }
+    for (int i = 0; i < count; i++) {
+        if (strcmp(workloads[i].name, name) == 0) {
+            return &workloads[i];
+        }
+    }
+    return NULL;
+}
+
+void run_workload(const workload_t *w, const allocator_t *alloc,
+                  const workload_params_t *params, workload_result_t *result) {
+    workload_params_t p = *params;
+    if (p.ops <= 0) p.ops = w->default_ops;
+    if (p.size <= 0) p.size = w->default_size;
+
+    result->ops = 0;
+    result->failed = 0;
+    seed_rand(p.seed);
+    allocator = alloc;
+    w->run(&p, result);
+}
@@ -0,0 +1,54 @@
+/**
+ *
+ * workloads.h: Allocation workloads shared by memgrind and the benchmarks
+ *
+ * Every workload takes two knobs so it can be swept from tiny smoke runs up
+ * to very long runs against a large heap:
+ *
+ *   ops  - total number of allocator operations to perform
+ *   size - working-set scale (live objects, table entries, tree nodes...)
+ *
+ * A value of 0 for either knob selects the workload's default, which is
+ * chosen so the working set fits in the default 4096 byte heap.
+ *
+ * Workloads never abort when malloc() returns NULL; they count the failure
+ * and carry on, so an undersized heap shows up in the results instead of
+ * crashing the run.
+ */
+
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+
+#include "allocators.h"
+
+typedef struct workload_params {
+    long ops;            // Total allocator operations (0 = default)
+    long size;           // Working-set scale (0 = default)
+    unsigned long seed;  // Seed for the workload's private random stream
+} workload_params_t;
+
+typedef struct workload_result {
+    long ops;            // Operations actually performed
+    long failed;         // Allocation requests that returned NULL
+} workload_result_t;
+
+typedef struct workload {
+    const char *name;
+    const char *description;
+    long default_ops;
+    long default_size;
+    void (*run)(const workload_params_t *params, workload_result_t *result);
+} workload_t;
+
+// Table of all workloads, terminated by an entry with a NULL name
+extern const workload_t workloads[];
+
+// Look up a workload by name or by its 1-based index in the table
+const workload_t *find_workload(const char *name);
+
+// Fill in defaults for any knob left at 0 and run the workload once,
+// allocating through `alloc`
+void run_workload(const workload_t *w, const allocator_t *alloc,
+                  const workload_params_t *params, workload_result_t *result);
+
+#endif